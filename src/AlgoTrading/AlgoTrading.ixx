@@ -4,4 +4,5 @@ export module AlgoTrading;
 
 export import MarketData;
 export import BrokerConnection;
-export import : Robot;
+export import TickSource;
+export import : Robot;
\ No newline at end of file
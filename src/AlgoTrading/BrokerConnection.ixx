@@ -45,6 +45,11 @@ export struct Order {
      */
     price takeprofit = -1;
 
+    /**
+     * @brief Index of the traded symbol in a multi-symbol simulation, zero for a single symbol.
+     */
+    size_t symbol = 0;
+
     bool hasStoploss() {
         return stoploss != -1;
     }
@@ -130,6 +135,11 @@ export struct Position {
         return takeprofit != -1;
     }
 
+    /**
+     * @brief Index of the symbol of the position in a multi-symbol simulation, zero for a single symbol.
+     */
+    size_t symbol = 0;
+
     bool hasPriceEvent() {
         return hasStoploss() || hasTakeprofit();
     }
@@ -213,6 +223,11 @@ public:
      */
     std::string comment;
 
+    /**
+     * @brief Index of the symbol of the trade in a multi-symbol simulation, zero for a single symbol.
+     */
+    size_t symbol = 0;
+
     /**
      * @brief Calculate realized profit on a given trade.
      * @return profit on a given trade.
@@ -244,6 +259,52 @@ public:
      */
     virtual bool getLastBars(Timeframe period, size_t count, BarsView& bars) = 0;
 
+    /**
+     * @brief Gets count of the symbols traded in the simulation, their indexes are in range [0, count).
+     * @return The count of the symbols.
+     */
+    virtual size_t getSymbolCount() {
+        return 1;
+    }
+
+    /**
+     * @brief Gets index of the symbol of the current tick (the one passed to onTick).
+     * @return The index of the symbol.
+     */
+    virtual size_t getCurrentSymbol() {
+        return 0;
+    }
+
+    /**
+     * @brief Retrieves historical price bars of a specified symbol for a specified timeframe.
+     *
+     * @param symbol Index of the symbol.
+     * @param period The timeframe of each bar.
+     * @param count number of bars to return.
+     * @param bars output parameter - the bars view will be stored here.
+     * @return True if the bars were found, false otherwise - not enough data or no tick of the symbol yet.
+     */
+    virtual bool getLastSymbolBars(size_t symbol, Timeframe period, size_t count, BarsView& bars) {
+        return symbol == getCurrentSymbol() && getLastBars(period, count, bars);
+    }
+
+    /**
+     * @brief Retrieves values of an indicator for the last bars of a specified timeframe.
+     *
+     * @param indicator The indicator to retrieve.
+     * @param period The timeframe of the bars the indicator is calculated over.
+     * @param indicator_period Count of the bars the indicator is calculated from (e.g. 20 for SMA(20)).
+     * @param count number of values to return.
+     * @param values output parameter - the values view will be stored here, the last value belongs to the current bar.
+     * @return True if the values were found, false otherwise - not enough data.
+     */
+    virtual bool getLastIndicatorValues(
+        Indicator indicator,
+        Timeframe period,
+        size_t indicator_period,
+        size_t count,
+        IndicatorValues& values) = 0;
+
     /**
      * @brief Retrieves historical price bars for a specified symbol and timeframe.
      *
@@ -86,6 +86,83 @@ export {
 
 	using Ticks = std::vector<Tick>;
 
+	/**
+	 * @brief Read-only view of ticks (e.g. of a Ticks vector or of a memory mapped tick cache).
+	 */
+	using TicksView = std::span<const Tick>;
+
+	/**
+	 * @brief Structure-of-arrays storage of ticks - every property is stored in its own contiguous column,
+	 * so scans touching only some of the properties do not drag the others through the cache.
+	 */
+	struct TickColumns {
+		std::vector<TimePoint> timestamps;
+		std::vector<price> bids;
+		std::vector<price> asks;
+		std::vector<volume> volumes;
+		std::vector<ChangeFlag> flags;
+
+		TickColumns() = default;
+
+		/**
+		 * @brief Converts ticks to columns.
+		 * @param ticks ticks to convert.
+		 */
+		explicit TickColumns(TicksView ticks) {
+			reserve(ticks.size());
+			for (const Tick& tick : ticks) {
+				push_back(tick);
+			}
+		}
+
+		size_t size() const {
+			return timestamps.size();
+		}
+
+		bool empty() const {
+			return timestamps.empty();
+		}
+
+		void reserve(size_t count) {
+			timestamps.reserve(count);
+			bids.reserve(count);
+			asks.reserve(count);
+			volumes.reserve(count);
+			flags.reserve(count);
+		}
+
+		void push_back(const Tick& tick) {
+			timestamps.push_back(tick.timestamp);
+			bids.push_back(tick.bid);
+			asks.push_back(tick.ask);
+			volumes.push_back(tick.volume);
+			flags.push_back(tick.flags);
+		}
+
+		/**
+		 * @brief Assembles the tick on the given position.
+		 * @param i position of the tick.
+		 * @return the assembled tick.
+		 */
+		Tick operator[](size_t i) const {
+			return { timestamps[i], bids[i], asks[i], volumes[i], flags[i] };
+		}
+
+		/**
+		 * @brief Converts the columns back to ticks.
+		 * @return the ticks.
+		 */
+		std::vector<Tick> toTicks() const {
+			std::vector<Tick> ticks;
+			ticks.reserve(size());
+			for (size_t i = 0; i < size(); ++i) {
+				ticks.push_back((*this)[i]);
+			}
+
+			return ticks;
+		}
+	};
+
 	/**
 	 * @brief Represents an OHLC (Open-High-Low-Close) bar for a specific timeframe.
 	 *
@@ -120,6 +197,17 @@ export {
 			close = tick.bid;
 			tick_volume += tick.volume;
 		}
+
+		/**
+		 * @brief Adds a following bar of a lower timeframe to the bar.
+		 * @param bar the bar to add.
+		 */
+		void addBar(const Bar& bar) {
+			high = std::max(high, bar.high);
+			low = std::min(low, bar.low);
+			close = bar.close;
+			tick_volume += bar.tick_volume;
+		}
 	};
 
 	/**
@@ -131,4 +219,47 @@ export {
 	 * @brief Bar view.
 	 */
 	using BarsView = std::span<const Bar>;
+
+	/**
+	 * @brief Technical indicators calculated over bars.
+	 */
+	enum class Indicator {
+		/**
+		 * @brief Simple moving average of the close prices.
+		 */
+		SMA,
+		/**
+		 * @brief Exponential moving average of the close prices, seeded by the SMA.
+		 */
+		EMA,
+		/**
+		 * @brief Average true range with Wilder's smoothing.
+		 */
+		ATR,
+		/**
+		 * @brief Relative strength index with Wilder's smoothing.
+		 */
+		RSI,
+		/**
+		 * @brief Upper Bollinger band - SMA plus two standard deviations of the close prices.
+		 */
+		BOLLINGER_UPPER,
+		/**
+		 * @brief Lower Bollinger band - SMA minus two standard deviations of the close prices.
+		 */
+		BOLLINGER_LOWER,
+		/**
+		 * @brief Lowest low price of the last period bars.
+		 */
+		LOWEST_LOW,
+		/**
+		 * @brief Highest high price of the last period bars.
+		 */
+		HIGHEST_HIGH,
+	};
+
+	/**
+	 * @brief View of indicator values, the value on position i belongs to the bar on the same position.
+	 */
+	using IndicatorValues = std::span<const price>;
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+
+export module TickSource;
+
+import MarketData;
+
+/**
+ * @brief Represents a pull-based source of ticks delivered in chunks.
+ *
+ * Allows to consume tick histories that do not fit into the memory at once.
+ */
+export class TickSource {
+public:
+	virtual ~TickSource() = default;
+
+	/**
+	 * @brief Gets the next chunk of ticks in time order.
+	 * @return the next chunk - valid only until the next call; empty if the source is exhausted.
+	 */
+	virtual TicksView next() = 0;
+};
+
+/**
+ * @brief Tick source serving ticks that are already in the memory by chunks of the given size.
+ */
+export class TicksViewSource : public TickSource {
+public:
+	/**
+	 * @brief Default count of ticks in one chunk.
+	 */
+	static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 16;
+
+	/**
+	 * @brief Constructs the source.
+	 * @param ticks ticks to serve - they have to outlive the source.
+	 * @param chunk_size count of ticks in one chunk.
+	 */
+	TicksViewSource(TicksView ticks, size_t chunk_size = DEFAULT_CHUNK_SIZE) noexcept :
+		_ticks(ticks), _chunk_size(std::max<size_t>(chunk_size, 1)) {}
+
+	TicksView next() override {
+		size_t count = std::min(_chunk_size, _ticks.size() - _position);
+		TicksView chunk = _ticks.subspan(_position, count);
+		_position += count;
+		return chunk;
+	}
+
+private:
+	TicksView _ticks;
+	size_t _chunk_size;
+	size_t _position = 0;
+};
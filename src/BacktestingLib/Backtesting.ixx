@@ -4,4 +4,11 @@ export import StrategyTester;
 
 export import SimulatedBrokerConnection;
 export import MarketDataManager; 
-export import StrategyOptimizer;
\ No newline at end of file
+export import Indicators;
+export import IndicatorKernels;
+export import StrategyOptimizer;
+export import ThreadPool;
+export import Objectives;
+export import ParameterSpace;
+export import MonteCarlo;
+export import PortfolioTester;
\ No newline at end of file
@@ -0,0 +1,467 @@
+module;
+
+#include <vector>
+#include <span>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define INDICATOR_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang compile the AVX2 kernels for AVX2 without enabling it for the whole library,
+// MSVC accepts the intrinsics without any flags.
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+export module IndicatorKernels;
+
+import AlgoTrading;
+
+using namespace std;
+
+/**
+ * @brief Instruction sets the kernels are implemented for.
+ */
+export enum class InstructionSet {
+	SCALAR,
+	AVX2,
+};
+
+/**
+ * @brief Detects whether the CPU and the operating system support AVX2.
+ * @return True if the AVX2 kernels can be used.
+ */
+bool detectAvx2() {
+#if defined(INDICATOR_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+	return __builtin_cpu_supports("avx2");
+#elif defined(INDICATOR_KERNELS_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+	bool has_avx = (info[2] & (1 << 28)) != 0;
+	__cpuidex(info, 7, 0);
+	bool has_avx2 = (info[1] & (1 << 5)) != 0;
+	return os_saves_ymm && has_avx && has_avx2;
+#else
+	return false;
+#endif
+}
+
+/**
+ * @brief Gets the best instruction set supported by the CPU, it is detected once.
+ * @return the instruction set used by default.
+ */
+export InstructionSet getBestInstructionSet() {
+	static const InstructionSet best = detectAvx2() ? InstructionSet::AVX2 : InstructionSet::SCALAR;
+	return best;
+}
+
+/**
+ * @brief Prices of bars stored in columns, so the kernels can stream through a single property.
+ */
+export struct BarColumns {
+	vector<price> opens;
+	vector<price> highs;
+	vector<price> lows;
+	vector<price> closes;
+
+	BarColumns() = default;
+
+	/**
+	 * @brief Extracts the columns from bars.
+	 * @param bars bars to convert.
+	 */
+	explicit BarColumns(BarsView bars) {
+		opens.reserve(bars.size());
+		highs.reserve(bars.size());
+		lows.reserve(bars.size());
+		closes.reserve(bars.size());
+		for (const Bar& bar : bars) {
+			opens.push_back(bar.open);
+			highs.push_back(bar.high);
+			lows.push_back(bar.low);
+			closes.push_back(bar.close);
+		}
+	}
+
+	size_t size() const {
+		return closes.size();
+	}
+};
+
+constexpr price NOT_A_NUMBER = std::numeric_limits<price>::quiet_NaN();
+
+/**
+ * @brief Checks that the output has the size of the input and that the period is positive.
+ */
+void checkArguments(std::span<const price> values, size_t period, std::span<price> results) {
+	if (period == 0) {
+		throw std::invalid_argument("Period has to be positive.");
+	}
+
+	if (values.size() != results.size()) {
+		throw std::invalid_argument("Results have to have the same size as the values.");
+	}
+}
+
+// ===== scalar kernels =====
+
+void prefixSumsScalar(std::span<const price> values, price offset, price* prefix_sums) {
+	price sum = 0;
+	prefix_sums[0] = 0;
+	for (size_t i = 0; i < values.size(); ++i) {
+		sum += values[i] - offset;
+		prefix_sums[i + 1] = sum;
+	}
+}
+
+void windowDifferencesScalar(const price* prefix_sums, size_t period, size_t count, price window_offset, price* results) {
+	for (size_t i = period - 1; i < count; ++i) {
+		results[i] = prefix_sums[i + 1] - prefix_sums[i + 1 - period] + window_offset;
+	}
+}
+
+/**
+ * @brief Calculates running extremes from the start and from the end of blocks of the period (van Herk/Gil-Werman).
+ * @note Every window of the period spans a suffix of one block and a prefix of the next one, so its extreme
+ * is a selection of two precomputed values - amortized O(1) per value regardless of the period.
+ */
+template <typename Select>
+void calculateBlockExtremes(std::span<const price> values, size_t period, vector<price>& prefixes, vector<price>& suffixes, Select select) {
+	size_t count = values.size();
+	prefixes.resize(count);
+	suffixes.resize(count);
+	for (size_t block = 0; block < count; block += period) {
+		size_t block_end = std::min(block + period, count);
+		prefixes[block] = values[block];
+		for (size_t i = block + 1; i < block_end; ++i) {
+			prefixes[i] = select(prefixes[i - 1], values[i]);
+		}
+
+		suffixes[block_end - 1] = values[block_end - 1];
+		for (size_t i = block_end - 1; i > block; --i) {
+			suffixes[i - 1] = select(suffixes[i], values[i - 1]);
+		}
+	}
+}
+
+template <typename Select>
+void rollingExtremeScalar(std::span<const price> values, size_t period, std::span<price> results, Select select) {
+	vector<price> prefixes;
+	vector<price> suffixes;
+	calculateBlockExtremes(values, period, prefixes, suffixes, select);
+	for (size_t i = period - 1; i < values.size(); ++i) {
+		results[i] = select(suffixes[i + 1 - period], prefixes[i]);
+	}
+}
+
+void trueRangesScalar(const price* highs, const price* lows, const price* closes, size_t count, price* results) {
+	for (size_t i = 1; i < count; ++i) {
+		price previous_close = closes[i - 1];
+		results[i] = std::max({ highs[i] - lows[i], std::abs(highs[i] - previous_close), std::abs(lows[i] - previous_close) });
+	}
+}
+
+// ===== AVX2 kernels =====
+
+#ifdef INDICATOR_KERNELS_X86
+
+TARGET_AVX2 void prefixSumsAvx2(std::span<const price> values, price offset, price* prefix_sums) {
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d offsets = _mm256_set1_pd(offset);
+	__m256d carry = zero;
+	size_t i = 0;
+	prefix_sums[0] = 0;
+	for (; i + 4 <= values.size(); i += 4) {
+		// in-register scan: [a, b, c, d] -> [a, a+b, a+b+c, a+b+c+d]
+		__m256d x = _mm256_sub_pd(_mm256_loadu_pd(values.data() + i), offsets);
+		__m256d shifted = _mm256_blend_pd(_mm256_permute4x64_pd(x, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0b0001);
+		x = _mm256_add_pd(x, shifted);
+		shifted = _mm256_blend_pd(_mm256_permute4x64_pd(x, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0b0011);
+		x = _mm256_add_pd(x, shifted);
+		x = _mm256_add_pd(x, carry);
+		_mm256_storeu_pd(prefix_sums + i + 1, x);
+		carry = _mm256_permute4x64_pd(x, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	price sum = prefix_sums[i];
+	for (; i < values.size(); ++i) {
+		sum += values[i] - offset;
+		prefix_sums[i + 1] = sum;
+	}
+}
+
+TARGET_AVX2 void windowDifferencesAvx2(const price* prefix_sums, size_t period, size_t count, price window_offset, price* results) {
+	const __m256d offsets = _mm256_set1_pd(window_offset);
+	size_t i = period - 1;
+	for (; i + 4 <= count; i += 4) {
+		__m256d newer = _mm256_loadu_pd(prefix_sums + i + 1);
+		__m256d older = _mm256_loadu_pd(prefix_sums + i + 1 - period);
+		_mm256_storeu_pd(results + i, _mm256_add_pd(_mm256_sub_pd(newer, older), offsets));
+	}
+
+	for (; i < count; ++i) {
+		results[i] = prefix_sums[i + 1] - prefix_sums[i + 1 - period] + window_offset;
+	}
+}
+
+template <bool IsMaximum>
+TARGET_AVX2 void rollingExtremeAvx2(std::span<const price> values, size_t period, std::span<price> results) {
+	auto select = [](price a, price b) { return IsMaximum ? std::max(a, b) : std::min(a, b); };
+	size_t count = values.size();
+	vector<price> prefixes;
+	vector<price> suffixes;
+	calculateBlockExtremes(values, period, prefixes, suffixes, select);
+
+	size_t i = period - 1;
+	for (; i + 4 <= count; i += 4) {
+		__m256d suffix = _mm256_loadu_pd(suffixes.data() + i + 1 - period);
+		__m256d prefix = _mm256_loadu_pd(prefixes.data() + i);
+		_mm256_storeu_pd(results.data() + i, IsMaximum ? _mm256_max_pd(suffix, prefix) : _mm256_min_pd(suffix, prefix));
+	}
+
+	for (; i < count; ++i) {
+		results[i] = select(suffixes[i + 1 - period], prefixes[i]);
+	}
+}
+
+TARGET_AVX2 void trueRangesAvx2(const price* highs, const price* lows, const price* closes, size_t count, price* results) {
+	const __m256d sign_mask = _mm256_set1_pd(-0.0);
+	size_t i = 1;
+	for (; i + 4 <= count; i += 4) {
+		__m256d high = _mm256_loadu_pd(highs + i);
+		__m256d low = _mm256_loadu_pd(lows + i);
+		__m256d previous_close = _mm256_loadu_pd(closes + i - 1);
+		__m256d range = _mm256_sub_pd(high, low);
+		__m256d high_gap = _mm256_andnot_pd(sign_mask, _mm256_sub_pd(high, previous_close));
+		__m256d low_gap = _mm256_andnot_pd(sign_mask, _mm256_sub_pd(low, previous_close));
+		_mm256_storeu_pd(results + i, _mm256_max_pd(range, _mm256_max_pd(high_gap, low_gap)));
+	}
+
+	for (; i < count; ++i) {
+		price previous_close = closes[i - 1];
+		results[i] = std::max({ highs[i] - lows[i], std::abs(highs[i] - previous_close), std::abs(lows[i] - previous_close) });
+	}
+}
+
+/**
+ * @brief Continues the EMA recursions of four series in the lanes of one register.
+ * @param values the input values
+ * @param start position of the first value to calculate - all four series have to be seeded before it
+ * @param alphas smoothing factors of the series
+ * @param results outputs of the four series
+ */
+TARGET_AVX2 void continueExponentialMovingAveragesAvx2(
+	std::span<const price> values,
+	size_t start,
+	const price alphas[4],
+	price* const results[4]) {
+	__m256d alpha = _mm256_loadu_pd(alphas);
+	__m256d average = _mm256_set_pd(results[3][start - 1], results[2][start - 1], results[1][start - 1], results[0][start - 1]);
+	alignas(32) price lanes[4];
+	for (size_t i = start; i < values.size(); ++i) {
+		__m256d value = _mm256_set1_pd(values[i]);
+		average = _mm256_add_pd(average, _mm256_mul_pd(alpha, _mm256_sub_pd(value, average)));
+		_mm256_store_pd(lanes, average);
+		results[0][i] = lanes[0];
+		results[1][i] = lanes[1];
+		results[2][i] = lanes[2];
+		results[3][i] = lanes[3];
+	}
+}
+
+#endif
+
+// ===== dispatching kernels =====
+
+/**
+ * @brief Calculates sums of all windows of the given period.
+ * @param values the input values
+ * @param period length of the window
+ * @param results output - sum of the window ending at the position, NaN for positions preceding the first whole window
+ * @param instruction_set instruction set to use
+ */
+export void rollingSum(
+	std::span<const price> values,
+	size_t period,
+	std::span<price> results,
+	InstructionSet instruction_set = getBestInstructionSet()) {
+	checkArguments(values, period, results);
+	std::fill(results.begin(), results.begin() + std::min(period - 1, results.size()), NOT_A_NUMBER);
+	if (values.size() < period) {
+		return;
+	}
+
+	// the windows are differences of prefix sums, summing the deviations from the first value instead of the prices
+	// keeps the prefix sums small, so they do not lose precision on long series
+	price offset = values[0];
+	vector<price> prefix_sums(values.size() + 1);
+#ifdef INDICATOR_KERNELS_X86
+	if (instruction_set == InstructionSet::AVX2) {
+		prefixSumsAvx2(values, offset, prefix_sums.data());
+		windowDifferencesAvx2(prefix_sums.data(), period, values.size(), offset * period, results.data());
+		return;
+	}
+#endif
+
+	prefixSumsScalar(values, offset, prefix_sums.data());
+	windowDifferencesScalar(prefix_sums.data(), period, values.size(), offset * period, results.data());
+}
+
+/**
+ * @brief Calculates minimums of all windows of the given period in amortized O(1) per value.
+ * @param values the input values
+ * @param period length of the window
+ * @param results output - minimum of the window ending at the position, NaN for positions preceding the first whole window
+ * @param instruction_set instruction set to use
+ */
+export void rollingMinimum(
+	std::span<const price> values,
+	size_t period,
+	std::span<price> results,
+	InstructionSet instruction_set = getBestInstructionSet()) {
+	checkArguments(values, period, results);
+	std::fill(results.begin(), results.begin() + std::min(period - 1, results.size()), NOT_A_NUMBER);
+	if (values.size() < period) {
+		return;
+	}
+
+#ifdef INDICATOR_KERNELS_X86
+	if (instruction_set == InstructionSet::AVX2) {
+		rollingExtremeAvx2<false>(values, period, results);
+		return;
+	}
+#endif
+
+	rollingExtremeScalar(values, period, results, [](price a, price b) { return std::min(a, b); });
+}
+
+/**
+ * @brief Calculates maximums of all windows of the given period in amortized O(1) per value.
+ * @param values the input values
+ * @param period length of the window
+ * @param results output - maximum of the window ending at the position, NaN for positions preceding the first whole window
+ * @param instruction_set instruction set to use
+ */
+export void rollingMaximum(
+	std::span<const price> values,
+	size_t period,
+	std::span<price> results,
+	InstructionSet instruction_set = getBestInstructionSet()) {
+	checkArguments(values, period, results);
+	std::fill(results.begin(), results.begin() + std::min(period - 1, results.size()), NOT_A_NUMBER);
+	if (values.size() < period) {
+		return;
+	}
+
+#ifdef INDICATOR_KERNELS_X86
+	if (instruction_set == InstructionSet::AVX2) {
+		rollingExtremeAvx2<true>(values, period, results);
+		return;
+	}
+#endif
+
+	rollingExtremeScalar(values, period, results, [](price a, price b) { return std::max(a, b); });
+}
+
+/**
+ * @brief Calculates true ranges of bars.
+ * @param bars the bars in columns
+ * @param results output - true range of every bar, the first bar has no previous close so its range is used
+ * @param instruction_set instruction set to use
+ */
+export void trueRanges(
+	const BarColumns& bars,
+	std::span<price> results,
+	InstructionSet instruction_set = getBestInstructionSet()) {
+	if (bars.size() != results.size()) {
+		throw std::invalid_argument("Results have to have the same size as the bars.");
+	}
+
+	if (bars.size() == 0) {
+		return;
+	}
+
+	results[0] = bars.highs[0] - bars.lows[0];
+#ifdef INDICATOR_KERNELS_X86
+	if (instruction_set == InstructionSet::AVX2) {
+		trueRangesAvx2(bars.highs.data(), bars.lows.data(), bars.closes.data(), bars.size(), results.data());
+		return;
+	}
+#endif
+
+	trueRangesScalar(bars.highs.data(), bars.lows.data(), bars.closes.data(), bars.size(), results.data());
+}
+
+/**
+ * @brief Calculates exponential moving averages of several periods over the same values.
+ * @note The recursion of one series is inherently sequential, so the vectorized kernel advances
+ * four series (periods) in the lanes of one register. Every series is seeded by the SMA of its first period values.
+ * @param values the input values
+ * @param periods periods of the averages
+ * @param results output - one series per period, NaN for positions preceding the seed
+ * @param instruction_set instruction set to use
+ */
+export void exponentialMovingAverages(
+	std::span<const price> values,
+	std::span<const size_t> periods,
+	vector<vector<price>>& results,
+	InstructionSet instruction_set = getBestInstructionSet()) {
+	results.assign(periods.size(), vector<price>(values.size(), NOT_A_NUMBER));
+	vector<price> alphas(periods.size());
+	for (size_t k = 0; k < periods.size(); ++k) {
+		size_t period = periods[k];
+		if (period == 0) {
+			throw std::invalid_argument("Period has to be positive.");
+		}
+
+		alphas[k] = 2.0 / (period + 1);
+		if (values.size() >= period) {
+			price sum = 0;
+			for (size_t i = 0; i < period; ++i) {
+				sum += values[i];
+			}
+
+			results[k][period - 1] = sum / period;
+		}
+	}
+
+	size_t k = 0;
+#ifdef INDICATOR_KERNELS_X86
+	if (instruction_set == InstructionSet::AVX2) {
+		for (; k + 4 <= periods.size(); k += 4) {
+			size_t last_seed = *std::max_element(periods.begin() + k, periods.begin() + k + 4) - 1;
+
+			// series seeded earlier are advanced to the last seed one by one
+			for (size_t lane = k; lane < k + 4; ++lane) {
+				for (size_t i = periods[lane]; i <= last_seed && i < values.size(); ++i) {
+					results[lane][i] = results[lane][i - 1] + alphas[lane] * (values[i] - results[lane][i - 1]);
+				}
+			}
+
+			if (last_seed + 1 >= values.size()) {
+				continue;
+			}
+
+			price* const lanes[4] = { results[k].data(), results[k + 1].data(), results[k + 2].data(), results[k + 3].data() };
+			continueExponentialMovingAveragesAvx2(values, last_seed + 1, alphas.data() + k, lanes);
+		}
+	}
+#endif
+
+	for (; k < periods.size(); ++k) {
+		for (size_t i = periods[k]; i < values.size(); ++i) {
+			results[k][i] = results[k][i - 1] + alphas[k] * (values[i] - results[k][i - 1]);
+		}
+	}
+}
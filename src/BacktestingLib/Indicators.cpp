@@ -0,0 +1,298 @@
+module;
+
+#include <vector>
+#include <span>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+export module Indicators;
+
+import AlgoTrading;
+import IndicatorKernels;
+
+using namespace std;
+
+/**
+ * @brief Count of standard deviations between the SMA and the Bollinger bands.
+ */
+export constexpr price BOLLINGER_DEVIATIONS = 2;
+
+/**
+ * @brief Value of an indicator that is not defined yet (during the warm-up period).
+ */
+export constexpr price UNDEFINED_VALUE = std::numeric_limits<price>::quiet_NaN();
+
+/**
+ * @brief Values of an indicator calculated over a bar series.
+ */
+export struct IndicatorSeries {
+	Indicator indicator;
+	Timeframe timeframe;
+	size_t period;
+
+	/**
+	 * @brief Values of the indicator - the value on position i belongs to the bar on the same position.
+	 */
+	vector<price> values;
+
+	/**
+	 * @brief Smoothed gains and losses of the RSI.
+	 */
+	vector<price> average_gains;
+	vector<price> average_losses;
+};
+
+/**
+ * @brief Gets position of the first bar having a defined value of the indicator.
+ * @param indicator the indicator
+ * @param period the period of the indicator
+ * @return position of the first defined value
+ */
+export size_t getFirstDefinedIndex(Indicator indicator, size_t period) {
+	// RSI needs one more bar - the first change of the close price is known at the second bar
+	return indicator == Indicator::RSI ? period : period - 1;
+}
+
+/**
+ * @brief Calculates mean of the close prices of bars in the range [begin, end).
+ */
+price meanOfCloses(BarsView bars, size_t begin, size_t end) {
+	price sum = 0;
+	for (size_t i = begin; i < end; ++i) {
+		sum += bars[i].close;
+	}
+
+	return sum / (end - begin);
+}
+
+/**
+ * @brief Calculates true range of the bar on the given position.
+ */
+price trueRange(BarsView bars, size_t i) {
+	price range = bars[i].high - bars[i].low;
+	if (i == 0) {
+		return range;
+	}
+
+	price previous_close = bars[i - 1].close;
+	return std::max({ range, std::abs(bars[i].high - previous_close), std::abs(bars[i].low - previous_close) });
+}
+
+/**
+ * @brief Calculates the value of the indicator for the bar on the given position.
+ * @note Recursive indicators use the value of the previous bar, so it has to be already calculated.
+ * @param series the series to calculate the value of
+ * @param bars the bars the series is calculated over
+ * @param i position of the bar
+ * @return value of the indicator
+ */
+price calculateValue(IndicatorSeries& series, BarsView bars, size_t i) {
+	const size_t period = series.period;
+	const vector<price>& values = series.values;
+	if (i < getFirstDefinedIndex(series.indicator, period)) {
+		return UNDEFINED_VALUE;
+	}
+
+	bool is_first = i == getFirstDefinedIndex(series.indicator, period);
+	switch (series.indicator) {
+	case Indicator::SMA:
+		return is_first
+			? meanOfCloses(bars, 0, period)
+			: values[i - 1] + (bars[i].close - bars[i - period].close) / period;
+	case Indicator::EMA: {
+		price alpha = 2.0 / (period + 1);
+		return is_first
+			? meanOfCloses(bars, 0, period)
+			: values[i - 1] + alpha * (bars[i].close - values[i - 1]);
+	}
+	case Indicator::ATR: {
+		if (is_first) {
+			price sum = 0;
+			for (size_t j = 0; j < period; ++j) {
+				sum += trueRange(bars, j);
+			}
+
+			return sum / period;
+		}
+
+		return (values[i - 1] * (period - 1) + trueRange(bars, i)) / period;
+	}
+	case Indicator::RSI: {
+		price average_gain;
+		price average_loss;
+		if (is_first) {
+			price gains = 0;
+			price losses = 0;
+			for (size_t j = 1; j <= period; ++j) {
+				price change = bars[j].close - bars[j - 1].close;
+				gains += std::max<price>(change, 0);
+				losses += std::max<price>(-change, 0);
+			}
+
+			average_gain = gains / period;
+			average_loss = losses / period;
+		}
+		else {
+			price change = bars[i].close - bars[i - 1].close;
+			average_gain = (series.average_gains[i - 1] * (period - 1) + std::max<price>(change, 0)) / period;
+			average_loss = (series.average_losses[i - 1] * (period - 1) + std::max<price>(-change, 0)) / period;
+		}
+
+		series.average_gains[i] = average_gain;
+		series.average_losses[i] = average_loss;
+		return average_loss == 0 ? 100 : 100 - 100 / (1 + average_gain / average_loss);
+	}
+	case Indicator::BOLLINGER_UPPER:
+	case Indicator::BOLLINGER_LOWER: {
+		size_t begin = i + 1 - period;
+		price mean = meanOfCloses(bars, begin, i + 1);
+		price squares = 0;
+		for (size_t j = begin; j <= i; ++j) {
+			squares += (bars[j].close - mean) * (bars[j].close - mean);
+		}
+
+		price deviation = BOLLINGER_DEVIATIONS * std::sqrt(squares / period);
+		return series.indicator == Indicator::BOLLINGER_UPPER ? mean + deviation : mean - deviation;
+	}
+	case Indicator::LOWEST_LOW: {
+		price lowest = bars[i + 1 - period].low;
+		for (size_t j = i + 2 - period; j <= i; ++j) {
+			lowest = std::min(lowest, bars[j].low);
+		}
+
+		return lowest;
+	}
+	case Indicator::HIGHEST_HIGH: {
+		price highest = bars[i + 1 - period].high;
+		for (size_t j = i + 2 - period; j <= i; ++j) {
+			highest = std::max(highest, bars[j].high);
+		}
+
+		return highest;
+	}
+	default:
+		throw std::invalid_argument("Unknown indicator");
+	}
+}
+
+/**
+ * @brief Calculates EMA series of several periods over the same bars at once.
+ * @note The kernel advances several periods in the lanes of one register, so the periods requested together
+ * are cheaper to calculate in one call than one by one.
+ * @param periods the periods of the averages
+ * @param bars the bars the averages are calculated over
+ * @return one series per period, values of the bars in the warm-up period are NaN
+ */
+export vector<vector<price>> calculateExponentialMovingAverages(std::span<const size_t> periods, BarsView bars) {
+	BarColumns columns(bars);
+	vector<vector<price>> results;
+	exponentialMovingAverages(columns.closes, periods, results);
+	return results;
+}
+
+/**
+ * @brief Calculates the whole series at once by the vectorized kernels.
+ * @param series the empty series to calculate
+ * @param bars the bars the series is calculated over
+ * @return True if the indicator has a kernel, false if it has to be calculated value by value.
+ */
+bool calculateByKernels(IndicatorSeries& series, BarsView bars) {
+	const size_t period = series.period;
+	vector<price>& values = series.values;
+	switch (series.indicator) {
+	case Indicator::SMA: {
+		BarColumns columns(bars);
+		values.resize(bars.size());
+		rollingSum(columns.closes, period, values);
+		for (price& value : values) {
+			value /= period;
+		}
+
+		return true;
+	}
+	case Indicator::EMA:
+		values = std::move(calculateExponentialMovingAverages(std::span(&period, 1), bars).front());
+		return true;
+	case Indicator::ATR: {
+		BarColumns columns(bars);
+		vector<price> ranges(bars.size());
+		trueRanges(columns, ranges);
+		values.assign(bars.size(), UNDEFINED_VALUE);
+		if (bars.size() < period) {
+			return true;
+		}
+
+		// Wilder's smoothing is sequential, only the true ranges are vectorized
+		price sum = 0;
+		for (size_t i = 0; i < period; ++i) {
+			sum += ranges[i];
+		}
+
+		values[period - 1] = sum / period;
+		for (size_t i = period; i < bars.size(); ++i) {
+			values[i] = (values[i - 1] * (period - 1) + ranges[i]) / period;
+		}
+
+		return true;
+	}
+	case Indicator::LOWEST_LOW: {
+		BarColumns columns(bars);
+		values.resize(bars.size());
+		rollingMinimum(columns.lows, period, values);
+		return true;
+	}
+	case Indicator::HIGHEST_HIGH: {
+		BarColumns columns(bars);
+		values.resize(bars.size());
+		rollingMaximum(columns.highs, period, values);
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+/**
+ * @brief Extends the series of the indicator to all the given bars.
+ * @note An empty series is calculated at once by the vectorized kernels where the indicator has them.
+ * The value of the last already calculated bar is recalculated, because the bar might have been unfinished.
+ * Only the new values are calculated, so keeping a series up to date with incrementally built bars
+ * costs O(1) per bar for the averages and the RSI and O(period) for the Bollinger bands and the extremes.
+ * @param series the series to extend
+ * @param bars the bars the series is calculated over - the previously used bars followed by the new ones
+ */
+export void extendIndicator(IndicatorSeries& series, BarsView bars) {
+	if (series.period == 0) {
+		throw std::invalid_argument("Period of an indicator has to be positive.");
+	}
+
+	if (series.values.empty() && calculateByKernels(series, bars)) {
+		return;
+	}
+
+	size_t from = series.values.empty() ? 0 : series.values.size() - 1;
+	series.values.resize(bars.size(), UNDEFINED_VALUE);
+	if (series.indicator == Indicator::RSI) {
+		series.average_gains.resize(bars.size(), UNDEFINED_VALUE);
+		series.average_losses.resize(bars.size(), UNDEFINED_VALUE);
+	}
+
+	for (size_t i = from; i < bars.size(); ++i) {
+		series.values[i] = calculateValue(series, bars, i);
+	}
+}
+
+/**
+ * @brief Calculates values of the indicator for all the bars.
+ * @param indicator the indicator
+ * @param period the period of the indicator
+ * @param bars the bars
+ * @return values of the indicator, values of the bars in the warm-up period are NaN
+ */
+export vector<price> calculateIndicator(Indicator indicator, size_t period, BarsView bars) {
+	IndicatorSeries series{ indicator, Timeframe::MIN1, period };
+	extendIndicator(series, bars);
+	return std::move(series.values);
+}
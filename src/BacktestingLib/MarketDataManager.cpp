@@ -1,37 +1,65 @@
 module;
-#include <unordered_map>
-#include <shared_mutex>
-#include <chrono>
+#include <atomic>
 #include <forward_list>
+#include <stdexcept>
+#include <chrono>
 #include <utility>
 #include <span>
 #include <vector>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <mutex>
+#include <cstdint>
+#include <execution>
+#include <thread>
 
 export module MarketDataManager;
 
 import AlgoTrading;
+import Indicators;
 using namespace std;
 
 /**
- * @brief Calculates bars from ticks.
- * @param timeframe the timeframe of the bars
+ * @brief Gets the open time of the clock-aligned bar of the given timeframe containing the given time.
+ * @note Bars up to D1 are aligned to multiples of their duration since the epoch (e.g. H1 bars to :00),
+ * W1 bars start on Sunday.
+ * @param timeframe the timeframe of the bar
+ * @param time the time within the bar
+ * @return open time of the bar
+ */
+export TimePoint getBarOpenTime(Timeframe timeframe, TimePoint time) {
+	using namespace std::chrono;
+
+	if (timeframe == Timeframe::W1) {
+		sys_days day = floor<days>(time);
+		return day - (weekday(day) - Sunday);
+	}
+
+	return time - time.time_since_epoch() % timeframe_durations[(int)timeframe];
+}
+
+/**
+ * @brief Calculates clock-aligned MIN1 bars from ticks.
  * @param ticks the ticks to calculate bars from
  * @return derived bars
  */
-export Bars calculateBars(Timeframe timeframe, const Ticks& ticks) {
+Bars calculateMinuteBars(TicksView ticks) {
 	Bars bars;
 	if (ticks.empty()) {
 		return bars;
 	}
 
-	std::chrono::milliseconds tf_duration = timeframe_durations[(int)timeframe];
 	Bar bar;
 	bar.openBar(ticks.front());
+	bar.open_timestamp = getBarOpenTime(Timeframe::MIN1, ticks.front().timestamp);
 	for (size_t i = 1; i < ticks.size(); ++i) {
 		const auto& tick = ticks[i];
-		if(tick.timestamp - bar.open_timestamp >= tf_duration) {
+		TimePoint open_time = getBarOpenTime(Timeframe::MIN1, tick.timestamp);
+		if (open_time != bar.open_timestamp) {
 			bars.push_back(bar);
 			bar.openBar(tick);
+			bar.open_timestamp = open_time;
 		}
 		else {
 			bar.addTick(tick);
@@ -42,6 +70,158 @@ export Bars calculateBars(Timeframe timeframe, const Ticks& ticks) {
 	return bars;
 }
 
+/**
+ * @brief Calculates clock-aligned MIN1 bars from a range of ticks stored in columns.
+ * @note Bar boundaries are found by scanning only the timestamp column, the bar values are then reduced
+ * over contiguous ranges of the price and volume columns.
+ * @param ticks the ticks to calculate bars from
+ * @param begin position of the first tick of the range
+ * @param end position behind the last tick of the range
+ * @return derived bars - the same as from the same ticks in Ticks
+ */
+Bars calculateMinuteBars(const TickColumns& ticks, size_t begin, size_t end) {
+	Bars bars;
+	const auto& timestamps = ticks.timestamps;
+	size_t bar_start = begin;
+	while (bar_start < end) {
+		TimePoint open_time = getBarOpenTime(Timeframe::MIN1, timestamps[bar_start]);
+		TimePoint close_time = open_time + timeframe_durations[(int)Timeframe::MIN1];
+		size_t bar_end = bar_start + 1;
+		while (bar_end < end && timestamps[bar_end] < close_time) {
+			++bar_end;
+		}
+
+		auto bids_begin = ticks.bids.begin() + bar_start;
+		auto bids_end = ticks.bids.begin() + bar_end;
+		auto asks_begin = ticks.asks.begin() + bar_start;
+		auto asks_end = ticks.asks.begin() + bar_end;
+		auto volumes_begin = ticks.volumes.begin() + bar_start;
+		auto volumes_end = ticks.volumes.begin() + bar_end;
+
+		// the same values as Bar::openBar followed by Bar::addTick for the rest of the ticks
+		bars.push_back({
+			open_time,
+			ticks.asks[bar_start],
+			*std::max_element(bids_begin, bids_end),
+			*std::min_element(asks_begin, asks_end),
+			ticks.bids[bar_end - 1],
+			std::reduce(volumes_begin, volumes_end, volume(0))
+			});
+
+		bar_start = bar_end;
+	}
+
+	return bars;
+}
+
+/**
+ * @brief Calculates clock-aligned MIN1 bars from ticks stored in columns.
+ * @param ticks the ticks to calculate bars from
+ * @return derived bars - the same as from the same ticks in Ticks
+ */
+Bars calculateMinuteBars(const TickColumns& ticks) {
+	return calculateMinuteBars(ticks, 0, ticks.size());
+}
+
+/**
+ * @brief Ranges smaller than this are not split any further, so the merging overhead stays negligible.
+ */
+constexpr size_t MIN_TICKS_PER_CHUNK = 1 << 16;
+
+/**
+ * @brief Calculates clock-aligned MIN1 bars by ranges of ticks in parallel.
+ * @note A bar cut by a boundary of the ranges ends the bars of one range and starts the bars of the next one,
+ * such pairs are merged back into a single bar.
+ * @tparam CalculateRange Callable calculating MIN1 bars of ticks in the range [begin, end).
+ * @param tick_count count of all the ticks
+ * @param calculate_range calculates MIN1 bars of a range of ticks
+ * @return derived bars - the same as calculated sequentially
+ */
+template <typename CalculateRange>
+Bars calculateMinuteBarsInParallel(size_t tick_count, CalculateRange calculate_range) {
+	size_t workers = std::max(1u, std::thread::hardware_concurrency());
+	size_t chunk_count = std::clamp<size_t>(tick_count / MIN_TICKS_PER_CHUNK, 1, workers * 4);
+
+	vector<Bars> chunks(chunk_count);
+	vector<size_t> chunk_indexes(chunk_count);
+	std::iota(chunk_indexes.begin(), chunk_indexes.end(), 0);
+	std::for_each(std::execution::par, chunk_indexes.begin(), chunk_indexes.end(), [&](size_t i) {
+		chunks[i] = calculate_range(tick_count * i / chunk_count, tick_count * (i + 1) / chunk_count);
+		});
+
+	Bars bars = std::move(chunks.front());
+	for (size_t i = 1; i < chunk_count; ++i) {
+		auto first = chunks[i].begin();
+		if (first != chunks[i].end() && !bars.empty() && first->open_timestamp == bars.back().open_timestamp) {
+			bars.back().addBar(*first);
+			++first;
+		}
+
+		bars.insert(bars.end(), first, chunks[i].end());
+	}
+
+	return bars;
+}
+
+/**
+ * @brief Calculates clock-aligned bars of the given timeframe from bars of the timeframe directly below it.
+ * @param timeframe the timeframe of the bars, higher than MIN1
+ * @param lower_bars bars of the timeframe directly below
+ * @return derived bars
+ */
+export Bars aggregateBars(Timeframe timeframe, BarsView lower_bars) {
+	Bars bars;
+	for (const Bar& lower_bar : lower_bars) {
+		TimePoint open_time = getBarOpenTime(timeframe, lower_bar.open_timestamp);
+		if (bars.empty() || bars.back().open_timestamp != open_time) {
+			bars.push_back(lower_bar);
+			bars.back().open_timestamp = open_time;
+		}
+		else {
+			bars.back().addBar(lower_bar);
+		}
+	}
+
+	return bars;
+}
+
+/**
+ * @brief Aggregates MIN1 bars level by level up to the given timeframe.
+ * @param timeframe the timeframe of the bars
+ * @param minute_bars MIN1 bars
+ * @return derived bars
+ */
+Bars aggregateMinuteBars(Timeframe timeframe, Bars minute_bars) {
+	Bars bars = std::move(minute_bars);
+	for (int level = (int)Timeframe::MIN1 + 1; level <= (int)timeframe; ++level) {
+		bars = aggregateBars((Timeframe)level, bars);
+	}
+
+	return bars;
+}
+
+/**
+ * @brief Calculates clock-aligned bars from ticks.
+ * @note MIN1 bars are calculated from the ticks, every higher timeframe from the timeframe below it.
+ * @param timeframe the timeframe of the bars
+ * @param ticks the ticks to calculate bars from
+ * @return derived bars
+ */
+export Bars calculateBars(Timeframe timeframe, TicksView ticks) {
+	return aggregateMinuteBars(timeframe, calculateMinuteBars(ticks));
+}
+
+/**
+ * @brief Calculates clock-aligned bars from ticks stored in columns.
+ * @note MIN1 bars are calculated from the ticks, every higher timeframe from the timeframe below it.
+ * @param timeframe the timeframe of the bars
+ * @param ticks the ticks to calculate bars from
+ * @return derived bars - the same as calculateBars over the same ticks in Ticks
+ */
+export Bars calculateBars(Timeframe timeframe, const TickColumns& ticks) {
+	return aggregateMinuteBars(timeframe, calculateMinuteBars(ticks));
+}
+
 /**
  * @brief Creates a view of a vector between given indexes.
  * @tparam T Type of the vector elements
@@ -60,6 +240,39 @@ std::span<const T> vector_slice(const std::vector<T>& data, int start, int end)
 }
 
 
+/**
+ * @brief Count of the timeframes.
+ */
+constexpr int TIMEFRAME_COUNT = (int)Timeframe::W1 + 1;
+
+export class MarketDataManager;
+
+/**
+ * @brief Remembers positions of the bars found by the previous lookups of a single simulation run.
+ * @note Time of a simulation only moves forward, so the next lookup continues from the remembered position
+ * instead of searching the whole bar history.
+ */
+export class BarLookupCursor {
+public:
+	BarLookupCursor() {
+		reset();
+	}
+
+	/**
+	 * @brief Forgets all the remembered positions.
+	 */
+	void reset() {
+		std::fill(std::begin(_positions), std::end(_positions), NO_POSITION);
+	}
+
+private:
+	friend class MarketDataManager;
+
+	static constexpr size_t NO_POSITION = std::numeric_limits<size_t>::max();
+
+	size_t _positions[TIMEFRAME_COUNT];
+};
+
 /**
  * @brief Manages market data.
  */
@@ -67,11 +280,92 @@ export class MarketDataManager {
 public:
 	/**
 	* @brief constructs instance of MarketDataManager.
-	* @param ticks the ticks from which to calculate bars.
+	* @param ticks the ticks from which to calculate bars - they have to outlive the manager.
 	*/
-	MarketDataManager(const Ticks& ticks) : _ticks(&ticks) {
-		_first_tick_time = ticks.front().timestamp;
-		_last_tick_time = ticks.back().timestamp;
+	MarketDataManager(TicksView ticks) : _ticks(ticks) {
+		if (!ticks.empty()) {
+			_first_tick_time = ticks.front().timestamp;
+			_last_tick_time = ticks.back().timestamp;
+		}
+	}
+
+	/**
+	* @brief constructs instance of MarketDataManager over ticks stored in columns.
+	* @param tick_columns the ticks from which to calculate bars - they have to outlive the manager.
+	*/
+	MarketDataManager(const TickColumns& tick_columns) : _tick_columns(&tick_columns) {
+		if (!tick_columns.empty()) {
+			_first_tick_time = tick_columns.timestamps.front();
+			_last_tick_time = tick_columns.timestamps.back();
+		}
+	}
+
+	/**
+	* @brief constructs instance of MarketDataManager that builds bars incrementally from ticks passed to addTick.
+	* @note Bars of all timeframes are kept up to date, so the memory is bounded by the bar history, not the tick one.
+	* Views returned by getLastBarsBefore are invalidated by the next call of addTick.
+	*/
+	MarketDataManager() : _incremental(true) {
+		for (int timeframe = 0; timeframe < TIMEFRAME_COUNT; ++timeframe) {
+			_published_bars[timeframe].store(&_bars[timeframe], memory_order_release);
+		}
+	}
+
+	/**
+	 * @brief Adds the next tick to the incrementally built bars.
+	 * @param tick tick following all the previously added ones.
+	 */
+	void addTick(const Tick& tick) {
+		if (_ticks_added++ == 0) {
+			_first_tick_time = tick.timestamp;
+		}
+
+		_last_tick_time = tick.timestamp;
+		for (int timeframe = 0; timeframe < TIMEFRAME_COUNT; ++timeframe) {
+			Bars& bars = _bars[timeframe];
+			TimePoint open_time = getBarOpenTime((Timeframe)timeframe, tick.timestamp);
+			if (bars.empty() || bars.back().open_timestamp != open_time) {
+				bars.emplace_back().openBar(tick);
+				bars.back().open_timestamp = open_time;
+			}
+			else {
+				bars.back().addTick(tick);
+			}
+		}
+	}
+
+	/**
+	 * @brief Calculates bars of the given timeframes and their tick-to-bar indexes in advance using all the cores.
+	 * @note Intended to be called before the simulation runs are fanned out, so no run stalls on the first creation
+	 * of bars. The ticks are split into ranges whose MIN1 bars are calculated in parallel. Does nothing
+	 * in the incremental mode.
+	 * @param timeframes the timeframes to calculate
+	 */
+	void precomputeBars(std::span<const Timeframe> timeframes) {
+		if (_incremental) {
+			return;
+		}
+
+		publish_bars(Timeframe::MIN1, [this]() {
+			if (_tick_columns != nullptr) {
+				return calculateMinuteBarsInParallel(_tick_columns->size(), [this](size_t begin, size_t end) {
+					return calculateMinuteBars(*_tick_columns, begin, end);
+					});
+			}
+
+			return calculateMinuteBarsInParallel(_ticks.size(), [this](size_t begin, size_t end) {
+				return calculateMinuteBars(_ticks.subspan(begin, end - begin));
+				});
+			});
+
+		// higher timeframes are aggregated from much fewer bars
+		for (Timeframe timeframe : timeframes) {
+			get_bars(timeframe);
+		}
+
+		std::for_each(std::execution::par, timeframes.begin(), timeframes.end(), [this](Timeframe timeframe) {
+			get_bar_index(timeframe);
+			});
 	}
 
 	/**
@@ -80,75 +374,400 @@ public:
 	 * @param before specifies the time before which the bars should be returned
 	 * @param count_of_bars how many bars to return
 	 * @param bars output parameter - the bars view will be stored here
+	 * @param cursor optional cursor of the simulation run - makes the lookups of non-decreasing times amortized O(1).
 	 * @return True if the bars were found, false otherwise - not enough data.
 	 */
-	bool getLastBarsBefore(Timeframe time_frame, TimePoint before, size_t count_of_bars, BarsView& bars) {
-		if (before <= _first_tick_time || before > _last_tick_time) {
+	bool getLastBarsBefore(
+		Timeframe time_frame,
+		TimePoint before,
+		size_t count_of_bars,
+		BarsView& bars,
+		BarLookupCursor* cursor = nullptr) {
+		int last_bar_index;
+		if (!find_last_bar_before(time_frame, before, cursor, last_bar_index)) {
+			return false;
+		}
+
+		int first_bar_index = last_bar_index - count_of_bars + 1;
+		if (first_bar_index < 0) {
 			return false;
 		}
 		
-		Bars* bars_ptr = nullptr;
-		if (!try_get_existing_bars(time_frame, bars_ptr)) {
-			if (!create_bars(time_frame, bars_ptr)) {
-				return false;
-			}
+		bars = vector_slice(get_bars(time_frame), first_bar_index, last_bar_index + 1);
+		return true;
+	}
+
+	/**
+	 * @brief Gets last bars of given timeframe at the time of the tick on the given position.
+	 * @note The bar is resolved by a tick-to-bar index of the timeframe, which is built on the first use
+	 * and then shared read-only by all the simulation runs. Returns the same bars as getLastBarsBefore
+	 * with the timestamp of the tick, it is not available in the incremental mode.
+	 * @param time_frame specifies the timeframe of the bars
+	 * @param tick_index position of the tick in the ticks of the manager
+	 * @param count_of_bars how many bars to return
+	 * @param bars output parameter - the bars view will be stored here
+	 * @return True if the bars were found, false otherwise - not enough data.
+	 */
+	bool getLastBarsAt(Timeframe time_frame, size_t tick_index, size_t count_of_bars, BarsView& bars) {
+		int last_bar_index;
+		if (!find_last_bar_at(time_frame, tick_index, last_bar_index)) {
+			return false;
 		}
 
-		// Find the last bar before the specified time
-		// Create appropriate view of the bars
-		int last_bar_index = find_index_of_bar_before(*bars_ptr, before);
 		int first_bar_index = last_bar_index - count_of_bars + 1;
 		if (first_bar_index < 0) {
 			return false;
 		}
-		
-		bars = vector_slice(*bars_ptr, first_bar_index, last_bar_index + 1);
+
+		bars = vector_slice(get_bars(time_frame), first_bar_index, last_bar_index + 1);
 		return true;
 	}
+
+	/**
+	 * @brief Gets the cached series of the indicator over bars of the given timeframe.
+	 * @note Every series is calculated only once and then shared by all the (possibly concurrent) simulation runs,
+	 * the returned pointer stays valid for the lifetime of the manager. In the incremental mode the series
+	 * is extended to the newly added bars whenever its values are read.
+	 * @param indicator the indicator
+	 * @param timeframe the timeframe of the bars
+	 * @param period the period of the indicator
+	 * @return the series of the indicator
+	 * @throws invalid_argument if the period is zero.
+	 */
+	IndicatorSeries* getIndicator(Indicator indicator, Timeframe timeframe, size_t period) {
+		if (period == 0) {
+			throw std::invalid_argument("Period of an indicator has to be positive.");
+		}
+
+		CachedIndicator* cached = find_indicator(indicator, timeframe, period);
+
+		// the series are calculated outside of the lock, so different indicators are calculated concurrently
+		if (!_incremental) {
+			call_once(cached->calculated, [this, cached]() {
+				extendIndicator(cached->series, get_bars(cached->series.timeframe));
+				});
+		}
+
+		return &cached->series;
+	}
+
+	/**
+	 * @brief Calculates series of the indicator with the given periods in advance.
+	 * @note Call it before the simulation runs are fanned out, e.g. with all the periods of a parameter space.
+	 * The EMA series are calculated together in a single call of the multi-period kernel, the other indicators
+	 * are calculated in parallel. Already calculated series are kept, a period given twice is calculated once.
+	 * Does nothing in the incremental mode.
+	 * @param indicator the indicator
+	 * @param timeframe the timeframe of the bars
+	 * @param periods the periods of the indicator
+	 * @throws invalid_argument if a period is zero.
+	 */
+	void precomputeIndicators(Indicator indicator, Timeframe timeframe, std::span<const size_t> periods) {
+		if (_incremental) {
+			return;
+		}
+
+		// the periods are checked in advance, an exception must not escape the parallel calculation
+		if (std::find(periods.begin(), periods.end(), size_t(0)) != periods.end()) {
+			throw std::invalid_argument("Period of an indicator has to be positive.");
+		}
+
+		if (indicator == Indicator::EMA) {
+			vector<CachedIndicator*> batch;
+			vector<size_t> batch_periods;
+			for (size_t period : periods) {
+				CachedIndicator* cached = find_indicator(indicator, timeframe, period);
+				if (std::find(batch.begin(), batch.end(), cached) == batch.end()) {
+					batch.push_back(cached);
+					batch_periods.push_back(period);
+				}
+			}
+
+			vector<vector<price>> results = calculateExponentialMovingAverages(batch_periods, get_bars(timeframe));
+			for (size_t k = 0; k < batch.size(); ++k) {
+				// a series calculated meanwhile is kept
+				call_once(batch[k]->calculated, [&]() {
+					batch[k]->series.values = std::move(results[k]);
+					});
+			}
+
+			return;
+		}
+
+		std::for_each(std::execution::par, periods.begin(), periods.end(), [&](size_t period) {
+			getIndicator(indicator, timeframe, period);
+			});
+	}
+
+	/**
+	 * @brief Gets last values of the indicator before specified time.
+	 * @param series the series of the indicator obtained by getIndicator
+	 * @param before specifies the time before which the values should be returned
+	 * @param count how many values to return
+	 * @param values output parameter - the values view will be stored here
+	 * @param cursor optional cursor of the simulation run - makes the lookups of non-decreasing times amortized O(1).
+	 * @return True if the values were found, false otherwise - not enough data.
+	 */
+	bool getLastIndicatorValuesBefore(
+		IndicatorSeries* series,
+		TimePoint before,
+		size_t count,
+		IndicatorValues& values,
+		BarLookupCursor* cursor = nullptr) {
+		int last_bar_index;
+		if (!find_last_bar_before(series->timeframe, before, cursor, last_bar_index)) {
+			return false;
+		}
+
+		return slice_indicator(*series, last_bar_index, count, values);
+	}
+
+	/**
+	 * @brief Gets last values of the indicator at the time of the tick on the given position.
+	 * @param series the series of the indicator obtained by getIndicator
+	 * @param tick_index position of the tick in the ticks of the manager
+	 * @param count how many values to return
+	 * @param values output parameter - the values view will be stored here
+	 * @return True if the values were found, false otherwise - not enough data.
+	 */
+	bool getLastIndicatorValuesAt(IndicatorSeries* series, size_t tick_index, size_t count, IndicatorValues& values) {
+		int last_bar_index;
+		if (!find_last_bar_at(series->timeframe, tick_index, last_bar_index)) {
+			return false;
+		}
+
+		return slice_indicator(*series, last_bar_index, count, values);
+	}
 private:
-	const Ticks* _ticks;
+	TicksView _ticks;
+	const TickColumns* _tick_columns = nullptr;
+	bool _incremental = false;
+	size_t _ticks_added = 0;
 	TimePoint _first_tick_time;
 	TimePoint _last_tick_time;
-	unordered_map<Timeframe, Bars*> _bars_by_timeframe;
-	forward_list<Bars> _bars;
-	mutable shared_mutex _mutex;
-
-	bool try_get_existing_bars(Timeframe timeframe, Bars*& bars_ptr) const {
-		shared_lock lock(_mutex);
-		auto it = _bars_by_timeframe.find(timeframe);
-		if (it == _bars_by_timeframe.end()) {
+
+	/**
+	 * @brief Bars of the timeframes, a timeframe is written only once before it is published
+	 * (except in the incremental mode, which is single threaded).
+	 */
+	Bars _bars[TIMEFRAME_COUNT];
+
+	/**
+	 * @brief Published bars - after the publication they are read without any locking.
+	 */
+	atomic<const Bars*> _published_bars[TIMEFRAME_COUNT] = {};
+	once_flag _bars_flags[TIMEFRAME_COUNT];
+
+	vector<uint32_t> _bar_index_by_tick[TIMEFRAME_COUNT];
+	atomic<const vector<uint32_t>*> _published_bar_indexes[TIMEFRAME_COUNT] = {};
+	once_flag _bar_index_flags[TIMEFRAME_COUNT];
+
+	/**
+	 * @brief Indicator series with a flag of its calculation.
+	 */
+	struct CachedIndicator {
+		IndicatorSeries series;
+		once_flag calculated;
+
+		CachedIndicator(Indicator indicator, Timeframe timeframe, size_t period) :
+			series{ indicator, timeframe, period } {}
+	};
+
+	/**
+	 * @brief Guards only the list of the indicators, not their calculation.
+	 */
+	mutex _indicators_mutex;
+	forward_list<CachedIndicator> _indicators;
+
+	/**
+	 * @brief Finds the cached indicator, adds a not calculated one if it is not cached yet.
+	 * @param indicator the indicator
+	 * @param timeframe the timeframe of the bars
+	 * @param period the period of the indicator
+	 * @return the cached indicator
+	 */
+	CachedIndicator* find_indicator(Indicator indicator, Timeframe timeframe, size_t period) {
+		lock_guard lock(_indicators_mutex);
+		auto it = std::find_if(_indicators.begin(), _indicators.end(), [&](const CachedIndicator& entry) {
+			return entry.series.indicator == indicator
+				&& entry.series.timeframe == timeframe
+				&& entry.series.period == period;
+			});
+		return it != _indicators.end() ? &*it : &_indicators.emplace_front(indicator, timeframe, period);
+	}
+
+	/**
+	 * @brief Finds the last bar of the timeframe before specified time.
+	 * @param timeframe the timeframe of the bars
+	 * @param before the time
+	 * @param cursor optional cursor of the simulation run
+	 * @param last_bar_index output parameter - position of the found bar
+	 * @return True if the bar was found, false otherwise - the time is out of the ticks.
+	 */
+	bool find_last_bar_before(Timeframe timeframe, TimePoint before, BarLookupCursor* cursor, int& last_bar_index) {
+		if ((_incremental && _ticks_added == 0) || before <= _first_tick_time || before > _last_tick_time) {
 			return false;
 		}
 
-		bars_ptr = it->second;
+		last_bar_index = find_index_of_bar_before(
+			get_bars(timeframe),
+			before,
+			cursor != nullptr ? &cursor->_positions[(int)timeframe] : nullptr);
 		return true;
 	}
 
-	int find_index_of_bar_before(const Bars& bars, TimePoint tp) {
-		size_t i = 0;
-		for (; i < bars.size(); ++i) {
-			if (bars[i].open_timestamp > tp) {
-				return i - 1;
-			}
+	/**
+	 * @brief Finds the last bar of the timeframe at the time of the tick on the given position.
+	 * @param timeframe the timeframe of the bars
+	 * @param tick_index position of the tick in the ticks of the manager
+	 * @param last_bar_index output parameter - position of the found bar
+	 * @return True if the bar was found, false otherwise - the tick is out of the ticks or in the incremental mode.
+	 */
+	bool find_last_bar_at(Timeframe timeframe, size_t tick_index, int& last_bar_index) {
+		if (_incremental || tick_index >= get_tick_count()) {
+			return false;
+		}
+
+		TimePoint time = get_tick_time(tick_index);
+		if (time <= _first_tick_time || time > _last_tick_time) {
+			return false;
 		}
 
-		return bars.size() - 1;
+		last_bar_index = get_bar_index(timeframe)[tick_index];
+		return true;
 	}
 
-	bool create_bars(Timeframe timeframe, Bars*& bars_ptr) {
-		unique_lock lock(_mutex);
-		auto it = _bars_by_timeframe.find(timeframe);
-		if (it != _bars_by_timeframe.end()) {
-			// Bars for this timeframe already exist
-			bars_ptr = it->second;
-			return true;
+	/**
+	 * @brief Creates view of the last values of the indicator ending with the given bar.
+	 * @param series the series of the indicator
+	 * @param last_bar_index position of the last bar
+	 * @param count how many values to return
+	 * @param values output parameter - the values view will be stored here
+	 * @return True if all the values are defined, false otherwise.
+	 */
+	bool slice_indicator(IndicatorSeries& series, int last_bar_index, size_t count, IndicatorValues& values) {
+		if (_incremental) {
+			extendIndicator(series, _bars[(int)series.timeframe]);
 		}
 
-		auto& bars_emplaced = _bars.emplace_front(calculateBars(timeframe, *_ticks));
-		_bars_by_timeframe[timeframe] = &bars_emplaced;
-		bars_ptr = &bars_emplaced;
+		int first_index = last_bar_index - count + 1;
+		if (first_index < (int)getFirstDefinedIndex(series.indicator, series.period)) {
+			return false;
+		}
+
+		values = vector_slice(series.values, first_index, last_bar_index + 1);
 		return true;
 	}
 
+	size_t get_tick_count() const {
+		return _tick_columns != nullptr ? _tick_columns->size() : _ticks.size();
+	}
+
+	TimePoint get_tick_time(size_t tick_index) const {
+		return _tick_columns != nullptr ? _tick_columns->timestamps[tick_index] : _ticks[tick_index].timestamp;
+	}
+
+	/**
+	 * @brief Gets bars of the timeframe, creates them on the first call - MIN1 bars from the ticks,
+	 * higher timeframes from the timeframe below.
+	 * @note Concurrent first calls create the bars once, the others wait for them. Once the bars are published
+	 * the call is a single atomic load.
+	 * @param timeframe the timeframe of the bars
+	 * @return the bars
+	 */
+	const Bars& get_bars(Timeframe timeframe) {
+		const Bars* bars_ptr = _published_bars[(int)timeframe].load(memory_order_acquire);
+		if (bars_ptr != nullptr) {
+			return *bars_ptr;
+		}
+
+		publish_bars(timeframe, [this, timeframe]() {
+			if (timeframe == Timeframe::MIN1) {
+				return _tick_columns != nullptr ? calculateMinuteBars(*_tick_columns) : calculateMinuteBars(_ticks);
+			}
+
+			return aggregateBars(timeframe, get_bars((Timeframe)((int)timeframe - 1)));
+			});
+
+		return *_published_bars[(int)timeframe].load(memory_order_acquire);
+	}
+
+	/**
+	 * @brief Calculates and publishes bars of the timeframe unless they were already published.
+	 * @tparam Calculate Callable returning the bars.
+	 * @param timeframe the timeframe of the bars
+	 * @param calculate calculates the bars
+	 */
+	template <typename Calculate>
+	void publish_bars(Timeframe timeframe, Calculate calculate) {
+		call_once(_bars_flags[(int)timeframe], [this, timeframe, &calculate]() {
+			_bars[(int)timeframe] = calculate();
+			_published_bars[(int)timeframe].store(&_bars[(int)timeframe], memory_order_release);
+			});
+	}
+
+	/**
+	 * @brief Gets the index mapping every tick to the last bar opened not later than the tick, builds it on the first call.
+	 * @param timeframe the timeframe of the bars
+	 * @return index of the bar for every tick.
+	 */
+	const vector<uint32_t>& get_bar_index(Timeframe timeframe) {
+		const vector<uint32_t>* bar_index_ptr = _published_bar_indexes[(int)timeframe].load(memory_order_acquire);
+		if (bar_index_ptr != nullptr) {
+			return *bar_index_ptr;
+		}
+
+		call_once(_bar_index_flags[(int)timeframe], [this, timeframe]() {
+			const Bars& bars = get_bars(timeframe);
+			vector<uint32_t>& bar_index = _bar_index_by_tick[(int)timeframe];
+			size_t tick_count = get_tick_count();
+			bar_index.resize(tick_count);
+			uint32_t bar = 0;
+			for (size_t i = 0; i < tick_count; ++i) {
+				TimePoint time = get_tick_time(i);
+				while (bar + 1 < bars.size() && bars[bar + 1].open_timestamp <= time) {
+					++bar;
+				}
+
+				bar_index[i] = bar;
+			}
+
+			_published_bar_indexes[(int)timeframe].store(&bar_index, memory_order_release);
+			});
+
+		return *_published_bar_indexes[(int)timeframe].load(memory_order_acquire);
+	}
+
+	/**
+	 * @brief Finds index of the last bar opened not later than the given time.
+	 * @param bars bars ordered by their open timestamps.
+	 * @param tp the time.
+	 * @param cursor_position optional position of the previously found bar, it is updated to the found one.
+	 * @return index of the bar or -1 if all the bars are opened later.
+	 */
+	int find_index_of_bar_before(const Bars& bars, TimePoint tp, size_t* cursor_position) {
+		if (cursor_position != nullptr) {
+			size_t i = *cursor_position;
+			if (i < bars.size() && bars[i].open_timestamp <= tp) {
+				// the time moved forward - usually it is still the same or the next bar
+				while (i + 1 < bars.size() && bars[i + 1].open_timestamp <= tp) {
+					++i;
+				}
+
+				*cursor_position = i;
+				return i;
+			}
+		}
+
+		auto it = std::upper_bound(bars.begin(), bars.end(), tp, [](TimePoint time, const Bar& bar) {
+			return time < bar.open_timestamp;
+			});
+		int index = (int)(it - bars.begin()) - 1;
+		if (cursor_position != nullptr && index >= 0) {
+			*cursor_position = index;
+		}
+
+		return index;
+	}
 };
 
@@ -0,0 +1,221 @@
+module;
+
+#include <vector>
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+export module MonteCarlo;
+
+import AlgoTrading;
+import TradingManager;
+import ThreadPool;
+
+namespace Backtesting {
+	using TradingResults = BackTesting::TradingManager::Results;
+
+	/**
+	 * @brief Specifies how the trade sequences of the Monte Carlo paths are generated.
+	 */
+	export enum class ResamplingMethod {
+		// trades drawn with replacement, the count of the trades is kept
+		BOOTSTRAP,
+		// the same trades in a random order, only the path (e.g. the drawdown) changes
+		SHUFFLE
+	};
+
+	/**
+	 * @brief Settings of the Monte Carlo analysis.
+	 */
+	export struct MonteCarloSettings {
+		/** @brief Count of the generated trade sequences. */
+		size_t path_count = 10000;
+		/** @brief How the sequences are generated. */
+		ResamplingMethod method = ResamplingMethod::BOOTSTRAP;
+		/** @brief Seed of the random generators, the same seed gives the same results regardless of the worker count. */
+		uint64_t seed = 0;
+	};
+
+	/**
+	 * @brief Represents percentiles and mean of a value over the Monte Carlo paths.
+	 */
+	export struct Distribution {
+		double mean = 0;
+		double percentile_5 = 0;
+		double percentile_25 = 0;
+		double median = 0;
+		double percentile_75 = 0;
+		double percentile_95 = 0;
+	};
+
+	/**
+	 * @brief Represents results of the Monte Carlo analysis.
+	 */
+	export struct MonteCarloResults {
+		size_t path_count = 0;
+		/** @brief Balance after the last trade of the path. */
+		Distribution final_balance;
+		/** @brief Largest decline of the balance from its previous peak. */
+		Distribution max_drawdown;
+		/** @brief Longest holding time (in seconds) of the trades of a path spent below the peak balance. */
+		Distribution longest_drawdown_duration;
+		/** @brief Part of the paths whose balance dropped to zero, such paths stop trading. */
+		double ruin_probability = 0;
+	};
+
+	/**
+	 * @brief Resamples the trades of the trading results to estimate the distributions of the final balance
+	 * and the drawdown.
+	 * @note The trades are kept as their profit and duration only. The paths are generated in parallel in jobs
+	 * of a fixed count of paths, every job has its own random generator seeded by the seed and the index of the job,
+	 * and only the statistics of a path are stored, not its trades.
+	 */
+	export class MonteCarloAnalyzer {
+	public:
+		/**
+		 * @brief Constructs the analyzer of the trades of the results.
+		 * @param results the analyzed trading results.
+		 */
+		explicit MonteCarloAnalyzer(const TradingResults& results) :
+			_initial_balance(results.summary.initial_balance) {
+			_trades.reserve(results.trades.size());
+			for (const Trade& trade : results.trades) {
+				_trades.push_back(CompactTrade{
+					trade.calculateProfit(),
+					std::chrono::duration<float>(trade.close_time - trade.open_time).count() });
+			}
+		}
+
+		/**
+		 * @brief Generates the paths on the thread pool and summarizes them.
+		 * @param thread_pool The thread pool to use.
+		 * @param settings Settings of the analysis.
+		 * @return the distributions over the paths.
+		 */
+		MonteCarloResults run(ThreadPool& thread_pool, const MonteCarloSettings& settings = MonteCarloSettings()) const {
+			MonteCarloResults results;
+			results.path_count = settings.path_count;
+			if (settings.path_count == 0) {
+				return results;
+			}
+
+			std::vector<double> final_balances(settings.path_count);
+			std::vector<double> max_drawdowns(settings.path_count);
+			std::vector<double> drawdown_durations(settings.path_count);
+			std::vector<char> is_ruined(settings.path_count);
+			size_t job_count = (settings.path_count + PATHS_PER_JOB - 1) / PATHS_PER_JOB;
+			thread_pool.parallelFor(job_count, [&](size_t job, size_t) {
+				std::seed_seq seed{ static_cast<uint32_t>(settings.seed), static_cast<uint32_t>(settings.seed >> 32), static_cast<uint32_t>(job) };
+				std::mt19937_64 random_generator(seed);
+				std::vector<uint32_t> order(_trades.size());
+				std::iota(order.begin(), order.end(), 0);
+				std::uniform_int_distribution<uint32_t> pick(0, _trades.empty() ? 0 : static_cast<uint32_t>(_trades.size() - 1));
+
+				size_t end = std::min((job + 1) * PATHS_PER_JOB, settings.path_count);
+				for (size_t path = job * PATHS_PER_JOB; path < end; ++path) {
+					if (settings.method == ResamplingMethod::SHUFFLE) {
+						std::shuffle(order.begin(), order.end(), random_generator);
+					}
+					else {
+						for (uint32_t& index : order) {
+							index = pick(random_generator);
+						}
+					}
+
+					PathStatistics statistics = simulatePath(order);
+					final_balances[path] = statistics.final_balance;
+					max_drawdowns[path] = statistics.max_drawdown;
+					drawdown_durations[path] = statistics.longest_drawdown_duration;
+					is_ruined[path] = statistics.is_ruined;
+				}
+				});
+
+			results.final_balance = summarize(final_balances);
+			results.max_drawdown = summarize(max_drawdowns);
+			results.longest_drawdown_duration = summarize(drawdown_durations);
+			results.ruin_probability = static_cast<double>(std::count(is_ruined.begin(), is_ruined.end(), 1)) / settings.path_count;
+			return results;
+		}
+
+	private:
+		/**
+		 * @brief Count of the paths generated by one job of the thread pool.
+		 */
+		static constexpr size_t PATHS_PER_JOB = 256;
+
+		/**
+		 * @brief Represents the trade by its profit and duration.
+		 */
+		struct CompactTrade {
+			double profit;
+			float duration_seconds;
+		};
+
+		/**
+		 * @brief Represents statistics of one generated path.
+		 */
+		struct PathStatistics {
+			double final_balance;
+			double max_drawdown;
+			double longest_drawdown_duration;
+			bool is_ruined;
+		};
+
+		double _initial_balance;
+		std::vector<CompactTrade> _trades;
+
+		/**
+		 * @brief Goes through the trades in the given order and calculates the statistics of the path.
+		 */
+		PathStatistics simulatePath(const std::vector<uint32_t>& order) const {
+			double balance = _initial_balance;
+			double peak_balance = balance;
+			PathStatistics statistics{ balance, 0, 0, false };
+			double drawdown_duration = 0;
+			for (uint32_t index : order) {
+				const CompactTrade& trade = _trades[index];
+				balance += trade.profit;
+				if (balance >= peak_balance) {
+					peak_balance = balance;
+					drawdown_duration = 0;
+				}
+				else {
+					drawdown_duration += trade.duration_seconds;
+					statistics.max_drawdown = std::max(statistics.max_drawdown, peak_balance - balance);
+					statistics.longest_drawdown_duration = std::max(statistics.longest_drawdown_duration, drawdown_duration);
+				}
+
+				if (balance <= 0) {
+					statistics.is_ruined = true;
+					break;
+				}
+			}
+
+			statistics.final_balance = balance;
+			return statistics;
+		}
+
+		/**
+		 * @brief Calculates the mean and the percentiles (nearest rank) of the values, the values are reordered.
+		 */
+		static Distribution summarize(std::vector<double>& values) {
+			auto percentile = [&values](double fraction) {
+				auto nth = values.begin() + static_cast<ptrdiff_t>(fraction * (values.size() - 1) + 0.5);
+				std::nth_element(values.begin(), nth, values.end());
+				return *nth;
+				};
+
+			Distribution distribution;
+			distribution.mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+			distribution.percentile_5 = percentile(0.05);
+			distribution.percentile_25 = percentile(0.25);
+			distribution.median = percentile(0.5);
+			distribution.percentile_75 = percentile(0.75);
+			distribution.percentile_95 = percentile(0.95);
+			return distribution;
+		}
+	};
+}
@@ -0,0 +1,315 @@
+module;
+
+#include <vector>
+#include <span>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include <functional>
+
+export module Objectives;
+
+import TradingManager;
+
+namespace Backtesting {
+	using BackTesting::TradingSummary;
+
+	/**
+	 * @brief Represents objective of the optimization - the higher score is the better.
+	 */
+	export using ObjectivePtr = double(*)(const TradingSummary&);
+
+	/**
+	 * @brief Scores by the final account balance.
+	 */
+	export double finalBalance(const TradingSummary& summary) {
+		return summary.account_balance;
+	}
+
+	/**
+	 * @brief Scores by the Sharpe ratio of the trade returns.
+	 */
+	export double sharpeRatio(const TradingSummary& summary) {
+		return summary.getSharpeRatio();
+	}
+
+	/**
+	 * @brief Scores by the ratio of the gross profit and the gross loss.
+	 */
+	export double profitFactor(const TradingSummary& summary) {
+		return summary.getProfitFactor();
+	}
+
+	/**
+	 * @brief Scores by the max drawdown - the smaller drawdown is the better.
+	 */
+	export double lowMaxDrawdown(const TradingSummary& summary) {
+		return -summary.max_drawdown;
+	}
+
+	/**
+	 * @brief Scores by the ratio of the profit and the max drawdown.
+	 */
+	export double returnToDrawdown(const TradingSummary& summary) {
+		return summary.getReturnToDrawdown();
+	}
+
+	/**
+	 * @brief Scores the summary by the objective, undefined scores are the worst.
+	 * @param objective the objective
+	 * @param summary the summary of the trading
+	 * @return the score
+	 */
+	export double score(ObjectivePtr objective, const TradingSummary& summary) {
+		double value = objective(summary);
+		return std::isnan(value) ? -std::numeric_limits<double>::infinity() : value;
+	}
+
+	/**
+	 * @brief Represents the summary of the combination on the given index scored by an objective.
+	 */
+	export struct ScoredSummary {
+		double score = -std::numeric_limits<double>::infinity();
+		size_t combination_index = std::numeric_limits<size_t>::max();
+		TradingSummary summary;
+	};
+
+	/**
+	 * @brief Compares the scored summaries, ties are resolved in favor of the earlier combination,
+	 * so the order does not depend on the order of the simulations.
+	 * @return True if the first summary is better than the second one.
+	 */
+	export bool isBetter(const ScoredSummary& a, const ScoredSummary& b) {
+		return a.score > b.score || (a.score == b.score && a.combination_index < b.combination_index);
+	}
+
+	/**
+	 * @brief Keeps the K best scored summaries.
+	 * @note The summaries are kept in a min-heap of K elements, so adding costs O(log K)
+	 * and every worker can keep its own instance and merge them at the end.
+	 */
+	export class TopK {
+	public:
+		/**
+		 * @brief Constructs empty top-K.
+		 * @param k count of the kept summaries.
+		 */
+		explicit TopK(size_t k) : _k(k) {
+			_heap.reserve(k);
+		}
+
+		/**
+		 * @brief Adds the summary if it is one of the K best.
+		 * @param scored the scored summary.
+		 */
+		void add(const ScoredSummary& scored) {
+			if (_k == 0) {
+				return;
+			}
+
+			if (_heap.size() < _k) {
+				_heap.push_back(scored);
+				std::push_heap(_heap.begin(), _heap.end(), isBetter);
+				return;
+			}
+
+			// the top of the heap is the worst kept summary
+			if (isBetter(scored, _heap.front())) {
+				std::pop_heap(_heap.begin(), _heap.end(), isBetter);
+				_heap.back() = scored;
+				std::push_heap(_heap.begin(), _heap.end(), isBetter);
+			}
+		}
+
+		/**
+		 * @brief Adds the summaries kept by the other top-K.
+		 * @param other the other top-K.
+		 */
+		void merge(const TopK& other) {
+			for (const ScoredSummary& scored : other._heap) {
+				add(scored);
+			}
+		}
+
+		/**
+		 * @brief Gets the kept summaries from the best one.
+		 * @return the sorted summaries.
+		 */
+		std::vector<ScoredSummary> getSorted() const {
+			std::vector<ScoredSummary> sorted = _heap;
+			std::sort(sorted.begin(), sorted.end(), isBetter);
+			return sorted;
+		}
+
+	private:
+		size_t _k;
+		std::vector<ScoredSummary> _heap;
+	};
+
+	/**
+	 * @brief Score of the K-th best simulation so far, shared by all the workers of an optimization.
+	 * @note Simulations whose optimistic score falls below the bound cannot get into the top-K, so they
+	 * can be aborted (see AbortRules). Reading the bound is a single relaxed atomic load, it only tightens.
+	 */
+	export class SharedScoreBound {
+	public:
+		/**
+		 * @brief Constructs the bound of the K best scores, it is minus infinity until K scores are added.
+		 * @param k count of the best scores.
+		 */
+		explicit SharedScoreBound(size_t k) : _k(k) {}
+
+		/**
+		 * @brief Adds score of a finished simulation.
+		 * @param score the score.
+		 */
+		void add(double score) {
+			if (_k == 0) {
+				return;
+			}
+
+			std::lock_guard lock(_mutex);
+			if (_scores.size() < _k) {
+				_scores.push_back(score);
+				std::push_heap(_scores.begin(), _scores.end(), std::greater<double>());
+			}
+			else if (score > _scores.front()) {
+				std::pop_heap(_scores.begin(), _scores.end(), std::greater<double>());
+				_scores.back() = score;
+				std::push_heap(_scores.begin(), _scores.end(), std::greater<double>());
+			}
+
+			if (_scores.size() == _k) {
+				_bound.store(_scores.front(), std::memory_order_relaxed);
+			}
+		}
+
+		/**
+		 * @brief Gets the score of the K-th best simulation so far.
+		 * @return the bound, minus infinity if less than K simulations were added.
+		 */
+		double get() const {
+			return _bound.load(std::memory_order_relaxed);
+		}
+
+	private:
+		size_t _k;
+		std::mutex _mutex;
+		std::vector<double> _scores;
+		std::atomic<double> _bound = -std::numeric_limits<double>::infinity();
+	};
+
+	/**
+	 * @brief Represents the summary of the combination on the given index scored by several objectives.
+	 */
+	export struct ParetoPoint {
+		std::vector<double> scores;
+		size_t combination_index;
+		TradingSummary summary;
+	};
+
+	/**
+	 * @brief Keeps the summaries that are not dominated in all the objectives by another one (Pareto front).
+	 * @note The front is bounded by the capacity - when it is exceeded, the point with the worst score
+	 * of the first objective is dropped, so the first objective should be the primary one.
+	 */
+	export class ParetoFront {
+	public:
+		/**
+		 * @brief Constructs empty front.
+		 * @param objectives the objectives of the front.
+		 * @param capacity the largest count of the kept points.
+		 * @throws invalid_argument if there are no objectives.
+		 */
+		ParetoFront(std::span<const ObjectivePtr> objectives, size_t capacity) :
+			_objectives(objectives.begin(), objectives.end()),
+			_capacity(capacity) {
+			if (_objectives.empty()) {
+				throw std::invalid_argument("Pareto front needs at least one objective.");
+			}
+		}
+
+		/**
+		 * @brief Scores the summary and adds it if it is not dominated.
+		 * @param combination_index index of the combination.
+		 * @param summary the summary of the trading.
+		 */
+		void add(size_t combination_index, const TradingSummary& summary) {
+			ParetoPoint point{ {}, combination_index, summary };
+			point.scores.reserve(_objectives.size());
+			for (ObjectivePtr objective : _objectives) {
+				point.scores.push_back(score(objective, summary));
+			}
+
+			add(std::move(point));
+		}
+
+		/**
+		 * @brief Adds the point if it is not dominated and removes the points dominated by it.
+		 * @param point the scored point.
+		 */
+		void add(ParetoPoint point) {
+			for (const ParetoPoint& kept : _points) {
+				if (dominates(kept, point)) {
+					return;
+				}
+			}
+
+			std::erase_if(_points, [&point](const ParetoPoint& kept) { return dominates(point, kept); });
+			_points.push_back(std::move(point));
+			if (_points.size() > _capacity) {
+				auto worst = std::min_element(_points.begin(), _points.end(), [](const ParetoPoint& a, const ParetoPoint& b) {
+					return a.scores[0] < b.scores[0] || (a.scores[0] == b.scores[0] && a.combination_index > b.combination_index);
+					});
+				_points.erase(worst);
+			}
+		}
+
+		/**
+		 * @brief Adds the points kept by the other front.
+		 * @param other the other front with the same objectives.
+		 */
+		void merge(const ParetoFront& other) {
+			for (const ParetoPoint& point : other._points) {
+				add(point);
+			}
+		}
+
+		/**
+		 * @brief Gets the points of the front ordered by the first objective from the best one.
+		 * @return the points.
+		 */
+		std::vector<ParetoPoint> getSorted() const {
+			std::vector<ParetoPoint> sorted = _points;
+			std::sort(sorted.begin(), sorted.end(), [](const ParetoPoint& a, const ParetoPoint& b) {
+				return a.scores[0] > b.scores[0] || (a.scores[0] == b.scores[0] && a.combination_index < b.combination_index);
+				});
+			return sorted;
+		}
+
+	private:
+		std::vector<ObjectivePtr> _objectives;
+		size_t _capacity;
+		std::vector<ParetoPoint> _points;
+
+		/**
+		 * @brief Checks whether the first point dominates the second one - it is not worse in any objective
+		 * and it is better in at least one. Points with equal scores are resolved in favor of the earlier combination.
+		 */
+		static bool dominates(const ParetoPoint& a, const ParetoPoint& b) {
+			bool is_better_somewhere = false;
+			for (size_t i = 0; i < a.scores.size(); ++i) {
+				if (a.scores[i] < b.scores[i]) {
+					return false;
+				}
+
+				is_better_somewhere = is_better_somewhere || a.scores[i] > b.scores[i];
+			}
+
+			return is_better_somewhere || a.combination_index < b.combination_index;
+		}
+	};
+}
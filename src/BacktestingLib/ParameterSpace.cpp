@@ -0,0 +1,217 @@
+module;
+
+#include <vector>
+#include <span>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <bit>
+
+export module ParameterSpace;
+
+namespace Backtesting {
+
+/**
+ * @brief Represents range of values of one parameter of a strategy.
+ */
+export struct ParameterRange {
+	/** @brief The smallest value. */
+	double min;
+	/** @brief The largest value. */
+	double max;
+	/** @brief Distance of the neighboring values, the range is continuous if it is zero. */
+	double step = 0;
+};
+
+/**
+ * @brief Describes the values of all the parameters of a strategy without materializing their combinations.
+ * @note Points of the space are addressed by unit coordinates in [0, 1) per parameter,
+ * so the samplers do not depend on the ranges.
+ */
+export class ParameterSpace {
+public:
+	/**
+	 * @brief Constructs the space of the given parameter ranges.
+	 * @param ranges the ranges of the parameters.
+	 * @throws invalid_argument if there are no ranges or a range is empty.
+	 */
+	explicit ParameterSpace(std::vector<ParameterRange> ranges) : _ranges(std::move(ranges)) {
+		if (_ranges.empty()) {
+			throw std::invalid_argument("Parameter space needs at least one parameter.");
+		}
+
+		for (const ParameterRange& range : _ranges) {
+			if (!(range.min <= range.max) || range.step < 0) {
+				throw std::invalid_argument("Parameter range is empty.");
+			}
+		}
+	}
+
+	/**
+	 * @brief Gets count of the parameters.
+	 * @return the count of the parameters.
+	 */
+	size_t getDimensionCount() const {
+		return _ranges.size();
+	}
+
+	/**
+	 * @brief Maps the unit coordinates to the values of the parameters, the values of the stepped ranges are
+	 * rounded down to the steps.
+	 * @param unit_point coordinates in [0, 1) per parameter.
+	 * @return the values of the parameters.
+	 */
+	std::vector<double> getValues(std::span<const double> unit_point) const {
+		std::vector<double> values(_ranges.size());
+		for (size_t i = 0; i < _ranges.size(); ++i) {
+			const ParameterRange& range = _ranges[i];
+			double unit = std::clamp(unit_point[i], 0.0, 1.0);
+			if (range.step == 0) {
+				values[i] = range.min + unit * (range.max - range.min);
+				continue;
+			}
+
+			// the small tolerance keeps the max when the range is not an exact multiple of the floating step
+			double count = std::floor((range.max - range.min) / range.step + 1e-9) + 1;
+			values[i] = range.min + range.step * std::min(std::floor(unit * count), count - 1);
+		}
+
+		return values;
+	}
+
+private:
+	std::vector<ParameterRange> _ranges;
+};
+
+/**
+ * @brief Generates the Sobol low-discrepancy sequence of points in the unit cube.
+ * @note The first 2^k points fill every dyadic interval of a single dimension exactly once, so even a short
+ * prefix covers the space evenly. The direction numbers are the ones of Joe and Kuo, the points are
+ * generated in the Gray code order. A seeded random digital shift (XOR of the coordinates) decorrelates
+ * independent sequences and keeps the equidistribution.
+ */
+export class SobolSequence {
+public:
+	/**
+	 * @brief The largest supported count of the dimensions.
+	 */
+	static constexpr size_t MAX_DIMENSION_COUNT = 12;
+
+	/**
+	 * @brief Constructs the sequence starting at the origin (or the shift).
+	 * @param dimension_count count of the coordinates of the points.
+	 * @param seed seed of the digital shift, no shift is applied if it is zero.
+	 * @throws invalid_argument if the dimension count is zero or exceeds MAX_DIMENSION_COUNT.
+	 */
+	explicit SobolSequence(size_t dimension_count, uint64_t seed = 0) :
+		_directions(dimension_count),
+		_state(dimension_count, 0) {
+		if (dimension_count == 0 || dimension_count > MAX_DIMENSION_COUNT) {
+			throw std::invalid_argument("Sobol sequence supports 1 to 12 dimensions.");
+		}
+
+		for (size_t dimension = 0; dimension < dimension_count; ++dimension) {
+			initializeDirections(dimension);
+		}
+
+		if (seed != 0) {
+			std::mt19937_64 random_generator(seed);
+			for (uint32_t& state : _state) {
+				state = static_cast<uint32_t>(random_generator());
+			}
+		}
+	}
+
+	/**
+	 * @brief Gets count of the coordinates of the points.
+	 * @return the count of the dimensions.
+	 */
+	size_t getDimensionCount() const {
+		return _state.size();
+	}
+
+	/**
+	 * @brief Writes the next point of the sequence.
+	 * @param point output parameter - coordinates in [0, 1), its size has to be the dimension count.
+	 */
+	void next(std::span<double> point) {
+		for (size_t dimension = 0; dimension < _state.size(); ++dimension) {
+			point[dimension] = std::ldexp(static_cast<double>(_state[dimension]), -BIT_COUNT);
+		}
+
+		// the next point differs by the direction of the lowest zero bit of the index
+		int bit = std::countr_one(_index++);
+		if (bit < BIT_COUNT) {
+			for (size_t dimension = 0; dimension < _state.size(); ++dimension) {
+				_state[dimension] ^= _directions[dimension][bit];
+			}
+		}
+	}
+
+private:
+	static constexpr int BIT_COUNT = 32;
+
+	/**
+	 * @brief Primitive polynomial and initial direction numbers of one dimension (Joe and Kuo).
+	 */
+	struct DirectionParameters {
+		unsigned degree;
+		uint32_t coefficients;
+		uint32_t initial[5];
+	};
+
+	static constexpr DirectionParameters direction_parameters[MAX_DIMENSION_COUNT - 1]{
+		{ 1, 0, { 1 } },
+		{ 2, 1, { 1, 3 } },
+		{ 3, 1, { 1, 3, 1 } },
+		{ 3, 2, { 1, 1, 1 } },
+		{ 4, 1, { 1, 1, 3, 3 } },
+		{ 4, 4, { 1, 3, 5, 13 } },
+		{ 5, 2, { 1, 1, 5, 5, 17 } },
+		{ 5, 4, { 1, 1, 5, 5, 5 } },
+		{ 5, 7, { 1, 1, 7, 11, 19 } },
+		{ 5, 11, { 1, 1, 5, 1, 1 } },
+		{ 5, 13, { 1, 1, 1, 3, 11 } },
+	};
+
+	std::vector<std::vector<uint32_t>> _directions;
+	std::vector<uint32_t> _state;
+	uint32_t _index = 0;
+
+	/**
+	 * @brief Calculates the direction numbers of the dimension by the recurrence of its primitive polynomial.
+	 */
+	void initializeDirections(size_t dimension) {
+		std::vector<uint32_t>& directions = _directions[dimension];
+		directions.resize(BIT_COUNT);
+		if (dimension == 0) {
+			for (int bit = 0; bit < BIT_COUNT; ++bit) {
+				directions[bit] = 1u << (BIT_COUNT - 1 - bit);
+			}
+
+			return;
+		}
+
+		const DirectionParameters& parameters = direction_parameters[dimension - 1];
+		unsigned degree = parameters.degree;
+		for (unsigned bit = 0; bit < BIT_COUNT; ++bit) {
+			if (bit < degree) {
+				directions[bit] = parameters.initial[bit] << (BIT_COUNT - 1 - bit);
+				continue;
+			}
+
+			uint32_t direction = directions[bit - degree] ^ (directions[bit - degree] >> degree);
+			for (unsigned j = 1; j < degree; ++j) {
+				if ((parameters.coefficients >> (degree - 1 - j)) & 1) {
+					direction ^= directions[bit - j];
+				}
+			}
+
+			directions[bit] = direction;
+		}
+	}
+};
+
+}
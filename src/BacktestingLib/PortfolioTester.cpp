@@ -0,0 +1,237 @@
+module;
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+export module PortfolioTester;
+
+import AlgoTrading;
+import SimulatedBrokerConnection;
+import TradingManager;
+import MarketDataManager;
+import StrategyTester;
+
+namespace Backtesting {
+	using BackTesting::TradingManager;
+
+	/**
+	 * @brief Merges the time ordered ticks of several symbols into one time ordered stream.
+	 * @note The next tick of every symbol is kept in a binary min-heap of K cursors ordered by the timestamp
+	 * (ties by the symbol index), so taking a tick costs O(log K) comparisons of cached timestamps and the ticks
+	 * are never copied. The top cursor is advanced in place and sifted down instead of a pop and a push.
+	 */
+	export class TickMerger {
+	public:
+		/**
+		 * @brief Constructs the merger positioned at the first tick.
+		 * @param ticks_by_symbol the time ordered ticks of every symbol - they have to outlive the merger.
+		 */
+		explicit TickMerger(std::span<const TicksView> ticks_by_symbol) :
+			_ticks_by_symbol(ticks_by_symbol) {
+			_heap.reserve(ticks_by_symbol.size());
+			for (size_t symbol = 0; symbol < ticks_by_symbol.size(); ++symbol) {
+				if (!ticks_by_symbol[symbol].empty()) {
+					_heap.push_back(Cursor{ ticks_by_symbol[symbol].front().timestamp, symbol, 0 });
+				}
+			}
+
+			std::make_heap(_heap.begin(), _heap.end(), isLater);
+		}
+
+		/**
+		 * @brief Takes the earliest tick not taken yet.
+		 * @param symbol output parameter - index of the symbol of the tick.
+		 * @param tick_index output parameter - position of the tick in the ticks of the symbol.
+		 * @return True if a tick was taken, false if all the ticks were taken.
+		 */
+		bool next(size_t& symbol, size_t& tick_index) {
+			if (_heap.empty()) {
+				return false;
+			}
+
+			Cursor& top = _heap.front();
+			symbol = top.symbol;
+			tick_index = top.tick_index;
+
+			TicksView ticks = _ticks_by_symbol[symbol];
+			if (++top.tick_index < ticks.size()) {
+				top.timestamp = ticks[top.tick_index].timestamp;
+				siftDownTop();
+			}
+			else {
+				std::pop_heap(_heap.begin(), _heap.end(), isLater);
+				_heap.pop_back();
+			}
+
+			return true;
+		}
+
+	private:
+		/**
+		 * @brief Position in the ticks of one symbol with the timestamp of its tick.
+		 */
+		struct Cursor {
+			TimePoint timestamp;
+			size_t symbol;
+			size_t tick_index;
+		};
+
+		std::span<const TicksView> _ticks_by_symbol;
+		std::vector<Cursor> _heap;
+
+		static bool isLater(const Cursor& a, const Cursor& b) {
+			return a.timestamp > b.timestamp || (a.timestamp == b.timestamp && a.symbol > b.symbol);
+		}
+
+		/**
+		 * @brief Moves the advanced top cursor down until its children are not earlier.
+		 */
+		void siftDownTop() {
+			Cursor moved = _heap.front();
+			size_t hole = 0;
+			size_t size = _heap.size();
+			for (size_t child = 1; child < size; child = 2 * hole + 1) {
+				if (child + 1 < size && isLater(_heap[child], _heap[child + 1])) {
+					++child;
+				}
+
+				if (!isLater(moved, _heap[child])) {
+					break;
+				}
+
+				_heap[hole] = _heap[child];
+				hole = child;
+			}
+
+			_heap[hole] = moved;
+		}
+	};
+
+	/**
+	 * @brief Class that simulates the trading of a strategy on several symbols with one account.
+	 * @note Every symbol has its own market data manager, the ticks of the symbols are merged in time order
+	 * and passed to the robot one by one. The robot gets the symbol of the tick by BrokerConnection::getCurrentSymbol,
+	 * it orders the symbol by Order::symbol and reads bars of the other symbols by BrokerConnection::getLastSymbolBars.
+	 * The positions of all the symbols share the balance and the margin of the account.
+	 */
+	export class PortfolioTester {
+	public:
+		/**
+		 * @brief Construct a Portfolio Tester object.
+		 * @param ticks_by_symbol time ordered ticks of every symbol, the index of the symbol is its position
+		 * - they have to outlive the tester.
+		 * @param period the period of the simulation, it is applied to every symbol separately.
+		 * @param account_properties the account properties to use in simulation.
+		 * @throws invalid_argument if there are no symbols.
+		 */
+		PortfolioTester(
+			std::vector<TicksView> ticks_by_symbol,
+			SimulationPeriod period,
+			AccountProperties&& account_properties) :
+			_ticks_by_symbol(std::move(ticks_by_symbol)),
+			_period(period),
+			_account_properties(account_properties) {
+			if (_ticks_by_symbol.empty()) {
+				throw std::invalid_argument("Portfolio needs at least one symbol.");
+			}
+
+			for (TicksView ticks : _ticks_by_symbol) {
+				_market_data_managers.push_back(std::make_unique<MarketDataManager>(ticks));
+				_market_data_manager_ptrs.push_back(_market_data_managers.back().get());
+			}
+		}
+
+		/**
+		 * @brief Gets count of the simulated symbols.
+		 * @return the count of the symbols.
+		 */
+		size_t getSymbolCount() const {
+			return _ticks_by_symbol.size();
+		}
+
+		/**
+		 * @brief Calculates bars of the given timeframes of every symbol in advance.
+		 * @param timeframes the timeframes used by the simulated robots.
+		 */
+		void precomputeBars(std::span<const Timeframe> timeframes) {
+			for (MarketDataManager* market_data_manager_ptr : _market_data_manager_ptrs) {
+				market_data_manager_ptr->precomputeBars(timeframes);
+			}
+		}
+
+		/**
+		 * @brief Runs the simulation of the strategy on the merged ticks of the symbols.
+		 * @param robot Robot to simulate.
+		 * @return Results of the robot's trading, the trades carry their symbols.
+		 */
+		TradingResults run(ATS& robot) {
+			TradingManager trading_manager(_account_properties, true, getSymbolCount());
+			simulate(trading_manager, robot);
+			return trading_manager.end();
+		}
+
+		/**
+		 * @brief Runs the simulation of the strategy on the merged ticks of the symbols without recording the trades.
+		 * @param robot Robot to simulate.
+		 * @return Summary of the robot's trading.
+		 */
+		TradingSummary runSummary(ATS& robot) {
+			TradingManager trading_manager(_account_properties, false, getSymbolCount());
+			simulate(trading_manager, robot);
+			return trading_manager.getSummary();
+		}
+
+	private:
+		std::vector<TicksView> _ticks_by_symbol;
+		std::vector<std::unique_ptr<MarketDataManager>> _market_data_managers;
+		std::vector<MarketDataManager*> _market_data_manager_ptrs;
+		SimulationPeriod _period;
+		AccountProperties _account_properties;
+
+		/**
+		 * @brief Simulates the robot trading through the trading manager.
+		 * @note With a period other than TICK every symbol is sampled like a single symbol by StrategyTester
+		 * - the first tick at or after the next step of the symbol is simulated.
+		 * @param trading_manager Trading manager to use in simulation.
+		 * @param robot the robot to simulate.
+		 */
+		void simulate(TradingManager& trading_manager, ATS& robot) {
+			SimulatedBrokerConnection broker_connection(&trading_manager, _market_data_manager_ptrs);
+			if (robot.start(&broker_connection) == ATS::ReturnCode::STOP) {
+				return;
+			}
+
+			std::vector<TimePoint> wait_for_timestamps(_ticks_by_symbol.size());
+			for (size_t symbol = 0; symbol < _ticks_by_symbol.size(); ++symbol) {
+				if (!_ticks_by_symbol[symbol].empty()) {
+					wait_for_timestamps[symbol] = _ticks_by_symbol[symbol].front().timestamp;
+				}
+			}
+
+			TickMerger merger(_ticks_by_symbol);
+			size_t symbol;
+			size_t tick_index;
+			while (merger.next(symbol, tick_index)) {
+				const Tick& tick = _ticks_by_symbol[symbol][tick_index];
+				if (_period != SimulationPeriod::TICK) {
+					if (tick.timestamp < wait_for_timestamps[symbol]) {
+						continue;
+					}
+
+					wait_for_timestamps[symbol] += timeframe_durations[(int)_period];
+				}
+
+				broker_connection.setCurrentTick(symbol, tick_index);
+				if (!handleTick(trading_manager, robot, tick, nullptr, symbol)) {
+					break;
+				}
+			}
+
+			robot.end();
+		}
+	};
+}
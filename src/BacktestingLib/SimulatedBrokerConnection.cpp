@@ -2,6 +2,9 @@ module;
 
 #include <string>
 #include <chrono>
+#include <limits>
+#include <vector>
+#include <span>
 
 export module SimulatedBrokerConnection;
 
@@ -9,6 +12,7 @@ import AlgoTrading;
 import BrokerConnection;
 import TradingManager;
 import MarketDataManager;
+import Indicators;
 
 using namespace BackTesting;
 
@@ -24,11 +28,32 @@ public:
 	*/
 	SimulatedBrokerConnection(
 		TradingManager* trading_manager_ptr,
-		MarketDataManager* market_data_manager_ptr) noexcept :
+		MarketDataManager* market_data_manager_ptr) :
+		SimulatedBrokerConnection(trading_manager_ptr, std::span(&market_data_manager_ptr, 1)) {}
+
+	/**
+	* @brief Constructor of the connection trading several symbols.
+	* @param trading_manager_ptr Pointer to the trading manager shared by the symbols.
+	* @param market_data_manager_ptrs Pointers to the market data managers of the symbols, in the order of the symbol indexes.
+	*/
+	SimulatedBrokerConnection(
+		TradingManager* trading_manager_ptr,
+		std::span<MarketDataManager* const> market_data_manager_ptrs) :
 		_trading_manager_ptr(trading_manager_ptr),
-		_market_data_manager_ptr(market_data_manager_ptr) {}
+		_market_data_manager_ptr(market_data_manager_ptrs.front()),
+		_market_data_manager_ptrs(market_data_manager_ptrs.begin(), market_data_manager_ptrs.end()),
+		_tick_indexes(market_data_manager_ptrs.size(), NO_TICK_INDEX) {}
 
 	bool getLastBars(Timeframe period, size_t count, BarsView& bars) override;
+	size_t getSymbolCount() override;
+	size_t getCurrentSymbol() override;
+	bool getLastSymbolBars(size_t symbol, Timeframe period, size_t count, BarsView& bars) override;
+	bool getLastIndicatorValues(
+		Indicator indicator,
+		Timeframe period,
+		size_t indicator_period,
+		size_t count,
+		IndicatorValues& values) override;
 	TimePoint getTime() override;
 	bool tryCreatePosition(const Order& order, Position::Id& positionId) override;
 	const Position& getPosition(Position::Id& positionId) override;
@@ -38,17 +63,121 @@ public:
 
 	double getBalance() override;
 	double getEquity() override;
+
+	/**
+	 * @brief Sets position of the currently simulated tick in the ticks of the market data manager,
+	 * the bars are then resolved by the precomputed tick-to-bar index instead of searching by time.
+	 * @param tick_index position of the current tick.
+	 */
+	void setCurrentTickIndex(size_t tick_index) noexcept {
+		_current_tick_index = tick_index;
+	}
+
+	/**
+	 * @brief Sets the symbol and the position of the currently simulated tick in the ticks of the symbol's
+	 * market data manager. The bars and indicators are then taken from the symbol's manager, the other
+	 * symbols keep the position of their last tick.
+	 * @param symbol index of the symbol of the current tick.
+	 * @param tick_index position of the current tick in the ticks of the symbol.
+	 */
+	void setCurrentTick(size_t symbol, size_t tick_index) noexcept {
+		_current_symbol = symbol;
+		_market_data_manager_ptr = _market_data_manager_ptrs[symbol];
+		_tick_indexes[symbol] = tick_index;
+		_current_tick_index = tick_index;
+	}
 private:
+	static constexpr size_t NO_TICK_INDEX = std::numeric_limits<size_t>::max();
+
+	/**
+	 * @brief Indicator of a market data manager used in this run.
+	 */
+	struct UsedIndicator {
+		MarketDataManager* market_data_manager_ptr;
+		IndicatorSeries* series;
+	};
+
 	TradingManager* _trading_manager_ptr;
 	MarketDataManager* _market_data_manager_ptr;
+	std::vector<MarketDataManager*> _market_data_manager_ptrs;
+	std::vector<size_t> _tick_indexes;
+	size_t _current_symbol = 0;
+	BarLookupCursor _bar_lookup_cursor;
+	size_t _current_tick_index = NO_TICK_INDEX;
+
+	/**
+	 * @brief Indicators used in this run - the shared cache of the market data manager is locked
+	 * only on the first use of an indicator.
+	 */
+	std::vector<UsedIndicator> _used_indicators;
+
+	IndicatorSeries* getIndicator(Indicator indicator, Timeframe period, size_t indicator_period);
 };
 
 bool SimulatedBrokerConnection::getLastBars(Timeframe period, size_t count, BarsView& bars) {
+	if (_current_tick_index != NO_TICK_INDEX) {
+		return _market_data_manager_ptr->getLastBarsAt(period, _current_tick_index, count, bars);
+	}
+
 	return _market_data_manager_ptr->getLastBarsBefore(
 		period,
 		getTime(),
 		count,
-		bars);
+		bars,
+		&_bar_lookup_cursor);
+}
+
+size_t SimulatedBrokerConnection::getSymbolCount() {
+	return _market_data_manager_ptrs.size();
+}
+
+size_t SimulatedBrokerConnection::getCurrentSymbol() {
+	return _current_symbol;
+}
+
+bool SimulatedBrokerConnection::getLastSymbolBars(size_t symbol, Timeframe period, size_t count, BarsView& bars) {
+	if (symbol == _current_symbol) {
+		return getLastBars(period, count, bars);
+	}
+
+	if (symbol >= _tick_indexes.size() || _tick_indexes[symbol] == NO_TICK_INDEX) {
+		return false;
+	}
+
+	return _market_data_manager_ptrs[symbol]->getLastBarsAt(period, _tick_indexes[symbol], count, bars);
+}
+
+bool SimulatedBrokerConnection::getLastIndicatorValues(
+	Indicator indicator,
+	Timeframe period,
+	size_t indicator_period,
+	size_t count,
+	IndicatorValues& values) {
+	IndicatorSeries* series = getIndicator(indicator, period, indicator_period);
+	if (_current_tick_index != NO_TICK_INDEX) {
+		return _market_data_manager_ptr->getLastIndicatorValuesAt(series, _current_tick_index, count, values);
+	}
+
+	return _market_data_manager_ptr->getLastIndicatorValuesBefore(
+		series,
+		getTime(),
+		count,
+		values,
+		&_bar_lookup_cursor);
+}
+
+IndicatorSeries* SimulatedBrokerConnection::getIndicator(Indicator indicator, Timeframe period, size_t indicator_period) {
+	for (const UsedIndicator& used : _used_indicators) {
+		IndicatorSeries* series = used.series;
+		if (used.market_data_manager_ptr == _market_data_manager_ptr
+			&& series->indicator == indicator && series->timeframe == period && series->period == indicator_period) {
+			return series;
+		}
+	}
+
+	IndicatorSeries* series = _market_data_manager_ptr->getIndicator(indicator, period, indicator_period);
+	_used_indicators.emplace_back(_market_data_manager_ptr, series);
+	return series;
 }
 
 bool SimulatedBrokerConnection::tryCreatePosition(const Order& order, Position::Id& positionId) {
@@ -1,17 +1,74 @@
 module;
 
 #include <vector>
+#include <algorithm>
 #include <numeric>
 #include <execution>
+#include <span>
+#include <limits>
 #include <utility>
+#include <random>
+#include <cstdint>
+#include <set>
 
 
 export module StrategyOptimizer;
 import StrategyTester;
+import ThreadPool;
+import Objectives;
+import ParameterSpace;
 import AlgoTrading;
 
 namespace Backtesting {
 
+/**
+ * @brief Settings of the evolutionary search (see StrategyOptimizer::findBestParametersEvolved).
+ */
+export struct EvolutionSettings {
+	/** @brief Count of the combinations in one generation. */
+	size_t population_size = 32;
+	/** @brief Largest count of the generations, the initial population is the first one. */
+	size_t generation_count = 20;
+	/** @brief Largest count of the simulations, the last generation is truncated to fit. */
+	size_t max_evaluations = std::numeric_limits<size_t>::max();
+	/** @brief Count of the best combinations passed to the next generation without evaluating them again. */
+	size_t elite_count = 2;
+	/** @brief Count of the combinations competing for being a parent. */
+	size_t tournament_size = 3;
+	/** @brief Probability that a child is a crossover of two parents instead of a copy of one. */
+	double crossover_probability = 0.9;
+	/** @brief Seed of the random generator, the same seed gives the same search regardless of the worker count. */
+	uint64_t seed = 0;
+};
+
+/**
+ * @brief Settings of the sampled search (see StrategyOptimizer::findBestParametersSampled).
+ */
+export struct SamplingSettings {
+	/** @brief Largest count of the simulations. */
+	size_t max_evaluations = 256;
+	/** @brief Part of the evaluations spent on the low-discrepancy sample of the whole space. */
+	double initial_fraction = 0.5;
+	/** @brief Count of the refinement waves sharing the rest of the evaluations. */
+	size_t wave_count = 4;
+	/** @brief Count of the best points the refinement waves sample around. */
+	size_t refined_count = 4;
+	/** @brief Seed of the digital shift of the Sobol sequence (see SobolSequence). */
+	uint64_t seed = 0;
+};
+
+/**
+ * @brief Sizes of the walk-forward windows in ticks (see StrategyOptimizer::walkForward).
+ */
+export struct WalkForwardSettings {
+	/** @brief Count of the ticks the parameters are optimized on. */
+	size_t in_sample_tick_count;
+	/** @brief Count of the ticks following the in-sample ones the winner is validated on. */
+	size_t out_of_sample_tick_count;
+	/** @brief Distance of the beginnings of the neighboring windows, the out-of-sample count is used if it is zero. */
+	size_t step_tick_count = 0;
+};
+
 /**
  * @brief Class for optimizing the parameters of a strategy.
  * @tparam AOS_T Type of the strategy.
@@ -25,6 +82,52 @@ public:
 	 */
 	using FactoryMethodPtr = AOS_T(*)(Param_T);
 
+	/**
+	 * @brief Represents method predicting relative cost of simulating a robot with given parameters.
+	 */
+	using CostMethodPtr = double(*)(const Param_T&);
+
+	/**
+	 * @brief Represents method returning a randomly changed copy of the parameters.
+	 */
+	using MutationMethodPtr = Param_T(*)(const Param_T&, std::mt19937_64&);
+
+	/**
+	 * @brief Represents method combining two parameters into a new one.
+	 */
+	using CrossoverMethodPtr = Param_T(*)(const Param_T&, const Param_T&, std::mt19937_64&);
+
+	/**
+	 * @brief Represents method creating parameters from the values of a parameter space.
+	 */
+	using ParametersMethodPtr = Param_T(*)(std::span<const double>);
+
+	/**
+	 * @brief Represents one window of the walk-forward optimization.
+	 */
+	struct WalkForwardWindow {
+		size_t in_sample_begin;
+		size_t out_of_sample_begin;
+		size_t out_of_sample_end;
+		/** @brief The best parameters of the in-sample ticks. */
+		Param_T parameters;
+		/** @brief Scored in-sample summary of the best parameters. */
+		ScoredSummary in_sample;
+		/** @brief Results of the best parameters on the out-of-sample ticks. */
+		TradingResults out_of_sample;
+	};
+
+	/**
+	 * @brief Represents results of the walk-forward optimization.
+	 */
+	struct WalkForwardResults {
+		std::vector<WalkForwardWindow> windows;
+		/** @brief Balance after every out-of-sample trade of all the windows, it starts with the initial balance. */
+		std::vector<double> equity;
+		/** @brief Statistics of the out-of-sample trading of all the windows as if it was one account. */
+		TradingSummary summary;
+	};
+
 	/**
 	 * @brief Constructor for the StrategyOptimizer.
 	 * @param _strategy_tester_ptr the strategy tester to use to test parameter combinations.
@@ -69,6 +172,484 @@ public:
 			transform);
 	}
 
+	/**
+	 * @brief Tests all combinations of parameters on the thread pool and returns the best one.
+	 * @note The combinations are compared by their summaries (the trades are not recorded) and every worker keeps
+	 * only its best summary, the full results are materialized by running the winner again.
+	 * Ties are resolved in favor of the earlier combination, so the result does not depend on the scheduling.
+	 * @param thread_pool The thread pool to use - its worker count sets the parallelism.
+	 * @param combinations Combinations of parameters to test.
+	 * @param cost_method Optional method predicting the cost of the combinations - the expensive ones are started first,
+	 * so they do not leave the other workers idle at the end.
+	 * @param objective The objective to maximize.
+	 * @param abort_rules Rules aborting hopeless simulations (see findTopParameters).
+	 * @return pair of the best trading results and the best parameters, value-initialized results and parameters
+	 * if all the simulations were pruned (no result).
+	 */
+	std::pair<TradingResults, Param_T> findBestParameters(
+		ThreadPool& thread_pool,
+		const std::vector<Param_T>& combinations,
+		CostMethodPtr cost_method = nullptr,
+		ObjectivePtr objective = finalBalance,
+		const AbortRules& abort_rules = AbortRules()) {
+		std::vector<ScoredSummary> best = findTopParameters(thread_pool, combinations, 1, objective, cost_method, abort_rules);
+		if (best.empty()) {
+			return std::pair<TradingResults, Param_T>();
+		}
+
+		return rerun(combinations, best.front().combination_index);
+	}
+
+	/**
+	 * @brief Tests all combinations of parameters on the thread pool and returns summaries of the K best ones.
+	 * @note Every worker keeps its own top-K, they are merged once all the combinations are tested.
+	 * @param thread_pool The thread pool to use.
+	 * @param combinations Combinations of parameters to test.
+	 * @param k Count of the returned combinations.
+	 * @param objective The objective to maximize.
+	 * @param cost_method Optional method predicting the cost of the combinations.
+	 * @param abort_rules Rules aborting hopeless simulations, the aborted ones are left out of the result. If the rules
+	 * have an optimistic score without a bound, the bound of the K best scores is shared by the workers.
+	 * @return scored summaries of the best finished combinations from the best one, fewer than K (or none)
+	 * if the others were pruned.
+	 */
+	std::vector<ScoredSummary> findTopParameters(
+		ThreadPool& thread_pool,
+		const std::vector<Param_T>& combinations,
+		size_t k,
+		ObjectivePtr objective = finalBalance,
+		CostMethodPtr cost_method = nullptr,
+		AbortRules abort_rules = AbortRules()) {
+		SharedScoreBound score_bound(k);
+		if (abort_rules.optimistic_score != nullptr && abort_rules.score_bound == nullptr) {
+			abort_rules.score_bound = &score_bound;
+		}
+
+		std::vector<TopK> top_by_worker(thread_pool.getWorkerCount(), TopK(k));
+		runOnThreadPool(thread_pool, combinations, cost_method, &abort_rules, [&](size_t worker_id, size_t index, const TradingSummary& summary) {
+			// the pruned simulations did not finish, so they have no score to rank by
+			if (summary.is_pruned) {
+				return;
+			}
+
+			// the bound tightens as the sweep progresses
+			double summary_score = score(objective, summary);
+			score_bound.add(summary_score);
+			top_by_worker[worker_id].add(ScoredSummary{ summary_score, index, summary });
+			});
+
+		TopK top(k);
+		for (const TopK& worker_top : top_by_worker) {
+			top.merge(worker_top);
+		}
+
+		return top.getSorted();
+	}
+
+	/**
+	 * @brief Tests all combinations of parameters on the thread pool and returns the combinations
+	 * that are not dominated in all the objectives by another one.
+	 * @note Every worker keeps its own front, they are merged once all the combinations are tested.
+	 * @param thread_pool The thread pool to use.
+	 * @param combinations Combinations of parameters to test.
+	 * @param objectives The objectives to maximize, the first one is the primary one (see ParetoFront).
+	 * @param capacity The largest count of the returned combinations.
+	 * @param cost_method Optional method predicting the cost of the combinations.
+	 * @return scored summaries of the front ordered by the first objective.
+	 */
+	std::vector<ParetoPoint> findParetoFront(
+		ThreadPool& thread_pool,
+		const std::vector<Param_T>& combinations,
+		std::span<const ObjectivePtr> objectives,
+		size_t capacity = DEFAULT_PARETO_CAPACITY,
+		CostMethodPtr cost_method = nullptr) {
+		std::vector<ParetoFront> front_by_worker(thread_pool.getWorkerCount(), ParetoFront(objectives, capacity));
+		runOnThreadPool(thread_pool, combinations, cost_method, nullptr, [&](size_t worker_id, size_t index, const TradingSummary& summary) {
+			front_by_worker[worker_id].add(index, summary);
+			});
+
+		ParetoFront front(objectives, capacity);
+		for (const ParetoFront& worker_front : front_by_worker) {
+			front.merge(worker_front);
+		}
+
+		return front.getSorted();
+	}
+
+	/**
+	 * @brief Searches for the best parameters by an evolutionary algorithm instead of testing all the combinations.
+	 * @note Every generation is evaluated on the thread pool, while the selection, crossover and mutation
+	 * run on the calling thread, so the search depends only on the seed. Parents are chosen by tournaments,
+	 * the elite is kept without evaluating it again and the search stops once the generation count
+	 * or the evaluation budget is reached.
+	 * @param thread_pool The thread pool to use.
+	 * @param initial_population The first generation - it is sampled if it is larger than the population size
+	 * and filled with mutations of its combinations if it is smaller.
+	 * @param mutation_method Method returning a randomly changed copy of the parameters.
+	 * @param crossover_method Method combining two parents into a child.
+	 * @param objective The objective to maximize.
+	 * @param settings Settings of the search.
+	 * @return pair of the trading results and the best parameters found.
+	 */
+	std::pair<TradingResults, Param_T> findBestParametersEvolved(
+		ThreadPool& thread_pool,
+		const std::vector<Param_T>& initial_population,
+		MutationMethodPtr mutation_method,
+		CrossoverMethodPtr crossover_method,
+		ObjectivePtr objective = finalBalance,
+		const EvolutionSettings& settings = EvolutionSettings()) {
+		size_t population_size = std::max<size_t>(settings.population_size, 1);
+		if (initial_population.empty() || settings.generation_count == 0 || settings.max_evaluations == 0) {
+			return std::pair<TradingResults, Param_T>();
+		}
+
+		std::mt19937_64 random_generator(settings.seed);
+		std::vector<Param_T> offspring = initial_population;
+		if (offspring.size() > population_size) {
+			std::shuffle(offspring.begin(), offspring.end(), random_generator);
+			offspring.resize(population_size);
+		}
+
+		while (offspring.size() < population_size) {
+			std::uniform_int_distribution<size_t> pick(0, initial_population.size() - 1);
+			offspring.push_back(mutation_method(initial_population[pick(random_generator)], random_generator));
+		}
+
+		// the combination indexes number the evaluations, so the ties are resolved in favor of the earlier one
+		std::vector<Param_T> evaluated;
+		std::vector<ScoredSummary> population;
+		size_t elite_count = std::min(settings.elite_count, population_size - 1);
+		for (size_t generation = 0; generation < settings.generation_count; ++generation) {
+			offspring.resize(std::min(offspring.size(), settings.max_evaluations - evaluated.size()));
+			size_t first_index = evaluated.size();
+			std::vector<ScoredSummary> scored(offspring.size());
+			runOnThreadPool(thread_pool, offspring, nullptr, nullptr, [&](size_t, size_t index, const TradingSummary& summary) {
+				scored[index] = ScoredSummary{ score(objective, summary), first_index + index, summary };
+				});
+			evaluated.insert(evaluated.end(), offspring.begin(), offspring.end());
+
+			std::sort(population.begin(), population.end(), isBetter);
+			population.resize(std::min(population.size(), elite_count));
+			population.insert(population.end(), scored.begin(), scored.end());
+			if (evaluated.size() >= settings.max_evaluations || generation + 1 == settings.generation_count) {
+				break;
+			}
+
+			offspring.clear();
+			std::sort(population.begin(), population.end(), isBetter);
+			std::uniform_int_distribution<size_t> pick(0, population.size() - 1);
+			std::bernoulli_distribution is_crossover(settings.crossover_probability);
+			auto select = [&]() -> const Param_T& {
+				size_t winner = pick(random_generator);
+				for (size_t i = 1; i < settings.tournament_size; ++i) {
+					winner = std::min(winner, pick(random_generator));
+				}
+
+				return evaluated[population[winner].combination_index];
+				};
+
+			while (offspring.size() + elite_count < population_size) {
+				const Param_T& parent = select();
+				Param_T child = is_crossover(random_generator)
+					? crossover_method(parent, select(), random_generator)
+					: parent;
+				offspring.push_back(mutation_method(child, random_generator));
+			}
+		}
+
+		auto best = std::min_element(population.begin(), population.end(), isBetter);
+		return rerun(evaluated, best->combination_index);
+	}
+
+	/**
+	 * @brief Optimizes the parameters on rolling in-sample windows and validates every winner on the following
+	 * out-of-sample window.
+	 * @note All the windows share the ticks and bars of the tester, the in-sample simulations of all the windows
+	 * are run on the thread pool at once and so are the out-of-sample ones. The stitched max drawdown is
+	 * the larger of the windows' drawdowns and the drawdown of the stitched balance.
+	 * @param thread_pool The thread pool to use.
+	 * @param combinations Combinations of parameters to test.
+	 * @param settings Sizes of the windows.
+	 * @param objective The objective to maximize in-sample.
+	 * @return the windows and their stitched out-of-sample results.
+	 */
+	WalkForwardResults walkForward(
+		ThreadPool& thread_pool,
+		const std::vector<Param_T>& combinations,
+		const WalkForwardSettings& settings,
+		ObjectivePtr objective = finalBalance) {
+		WalkForwardResults results;
+		size_t tick_count = _strategy_tester_ptr->getTickCount();
+		size_t window_size = settings.in_sample_tick_count + settings.out_of_sample_tick_count;
+		size_t step = settings.step_tick_count != 0 ? settings.step_tick_count : settings.out_of_sample_tick_count;
+		if (combinations.empty() || settings.out_of_sample_tick_count == 0 || step == 0) {
+			return results;
+		}
+
+		for (size_t begin = 0; begin + window_size <= tick_count; begin += step) {
+			results.windows.push_back(WalkForwardWindow{
+				begin,
+				begin + settings.in_sample_tick_count,
+				begin + window_size });
+		}
+
+		// every worker keeps the best in-sample summary of every window
+		size_t window_count = results.windows.size();
+		std::vector<std::vector<ScoredSummary>> best_by_worker(thread_pool.getWorkerCount(), std::vector<ScoredSummary>(window_count));
+		thread_pool.parallelFor(window_count * combinations.size(), [&](size_t index, size_t worker_id) {
+			const WalkForwardWindow& window = results.windows[index / combinations.size()];
+			size_t combination_index = index % combinations.size();
+			AOS_T aos = _factory_method(combinations[combination_index]);
+			TradingSummary summary = _strategy_tester_ptr->runSummary(aos, window.in_sample_begin, window.out_of_sample_begin);
+			ScoredSummary scored{ score(objective, summary), combination_index, summary };
+			ScoredSummary& best = best_by_worker[worker_id][index / combinations.size()];
+			if (isBetter(scored, best)) {
+				best = scored;
+			}
+			});
+
+		thread_pool.parallelFor(window_count, [&](size_t index, size_t) {
+			WalkForwardWindow& window = results.windows[index];
+			for (const std::vector<ScoredSummary>& worker_best : best_by_worker) {
+				if (isBetter(worker_best[index], window.in_sample)) {
+					window.in_sample = worker_best[index];
+				}
+			}
+
+			window.parameters = combinations[window.in_sample.combination_index];
+			AOS_T aos = _factory_method(window.parameters);
+			window.out_of_sample = _strategy_tester_ptr->run(aos, window.out_of_sample_begin, window.out_of_sample_end);
+			});
+
+		stitch(results);
+		return results;
+	}
+
+	/**
+	 * @brief Searches for the best parameters by sampling the parameter space instead of testing all the combinations.
+	 * @note The first part of the budget is spent on the Sobol sample of the whole space, the rest is shared by
+	 * the refinement waves sampling boxes around the best points so far, the boxes shrink by half every wave.
+	 * Every wave is evaluated on the thread pool. The points mapped to already tested values are skipped,
+	 * so a small stepped space is never tested twice.
+	 * @param thread_pool The thread pool to use.
+	 * @param parameter_space Ranges of the parameters.
+	 * @param parameters_method Method creating the parameters from the values of the space.
+	 * @param objective The objective to maximize.
+	 * @param settings Settings of the search.
+	 * @return pair of the trading results and the best parameters found.
+	 */
+	std::pair<TradingResults, Param_T> findBestParametersSampled(
+		ThreadPool& thread_pool,
+		const ParameterSpace& parameter_space,
+		ParametersMethodPtr parameters_method,
+		ObjectivePtr objective = finalBalance,
+		const SamplingSettings& settings = SamplingSettings()) {
+		if (settings.max_evaluations == 0) {
+			return std::pair<TradingResults, Param_T>();
+		}
+
+		size_t dimension_count = parameter_space.getDimensionCount();
+		SobolSequence sequence(dimension_count, settings.seed);
+		std::set<std::vector<double>> tested_values;
+		std::vector<std::vector<double>> unit_points;
+		std::vector<Param_T> evaluated;
+		std::vector<ScoredSummary> scored;
+
+		// proposes up to count new points and evaluates them, the combination indexes number the evaluations
+		auto evaluateWave = [&](size_t count, auto propose) {
+			std::vector<Param_T> wave;
+			std::vector<double> unit_point(dimension_count);
+			for (size_t attempt = 0; wave.size() < count && attempt < count * MAX_SAMPLE_ATTEMPTS; ++attempt) {
+				propose(unit_point);
+				std::vector<double> values = parameter_space.getValues(unit_point);
+				if (tested_values.insert(values).second) {
+					unit_points.push_back(unit_point);
+					wave.push_back(parameters_method(values));
+				}
+			}
+
+			size_t first_index = evaluated.size();
+			scored.resize(first_index + wave.size());
+			runOnThreadPool(thread_pool, wave, nullptr, nullptr, [&](size_t, size_t index, const TradingSummary& summary) {
+				scored[first_index + index] = ScoredSummary{ score(objective, summary), first_index + index, summary };
+				});
+			evaluated.insert(evaluated.end(), wave.begin(), wave.end());
+			};
+
+		size_t initial_count = static_cast<size_t>(settings.max_evaluations * std::clamp(settings.initial_fraction, 0.0, 1.0));
+		evaluateWave(std::clamp<size_t>(initial_count, 1, settings.max_evaluations), [&](std::vector<double>& unit_point) {
+			sequence.next(unit_point);
+			});
+
+		double radius = INITIAL_REFINEMENT_RADIUS;
+		for (size_t wave = 0; wave < settings.wave_count && !scored.empty(); ++wave, radius /= 2) {
+			size_t count = (settings.max_evaluations - evaluated.size()) / (settings.wave_count - wave);
+			std::vector<ScoredSummary> centers(std::min(std::max<size_t>(settings.refined_count, 1), scored.size()));
+			std::partial_sort_copy(scored.begin(), scored.end(), centers.begin(), centers.end(), isBetter);
+
+			size_t proposal_count = 0;
+			std::vector<double> offset(dimension_count);
+			evaluateWave(count, [&](std::vector<double>& unit_point) {
+				const std::vector<double>& center = unit_points[centers[proposal_count++ % centers.size()].combination_index];
+				sequence.next(offset);
+				for (size_t i = 0; i < dimension_count; ++i) {
+					unit_point[i] = std::clamp(center[i] + (2 * offset[i] - 1) * radius, 0.0, 1.0);
+				}
+				});
+		}
+
+		if (scored.empty()) {
+			return std::pair<TradingResults, Param_T>();
+		}
+
+		auto best = std::min_element(scored.begin(), scored.end(), isBetter);
+		return rerun(evaluated, best->combination_index);
+	}
+
+	/**
+	 * @brief Searches for the best parameters by successive halving over growing prefixes of the ticks.
+	 * @note All the combinations are tested on the first 1/2^(round_count - 1) of the ticks, the best
+	 * 1/reduction_factor of them are tested again on twice as many ticks and so on, until the survivors are tested
+	 * on all the ticks. Every round is run on the thread pool. With the default settings about a sixteenth
+	 * of the ticks of the grid search is simulated, and less than a tenth from 64 combinations on (the winner
+	 * is run once more). The first round sees only 1/32 of the ticks - fewer rounds trade the speed for
+	 * a longer first prefix.
+	 * @param thread_pool The thread pool to use.
+	 * @param combinations Combinations of parameters to test.
+	 * @param objective The objective to maximize, it is evaluated on the prefixes too.
+	 * @param round_count Count of the rounds, one round tests all the combinations on all the ticks.
+	 * @param reduction_factor How many times fewer combinations survive each round.
+	 * @return pair of the trading results and the best parameters of the last round.
+	 */
+	std::pair<TradingResults, Param_T> findBestParametersHalving(
+		ThreadPool& thread_pool,
+		const std::vector<Param_T>& combinations,
+		ObjectivePtr objective = finalBalance,
+		size_t round_count = DEFAULT_HALVING_ROUNDS,
+		size_t reduction_factor = DEFAULT_HALVING_REDUCTION) {
+		if (combinations.empty()) {
+			return std::pair<TradingResults, Param_T>();
+		}
+
+		round_count = std::max<size_t>(round_count, 1);
+		reduction_factor = std::max<size_t>(reduction_factor, 1);
+		size_t tick_count = _strategy_tester_ptr->getTickCount();
+		std::vector<size_t> candidates(combinations.size());
+		std::iota(candidates.begin(), candidates.end(), 0);
+		for (size_t round = 0; round < round_count; ++round) {
+			size_t end = tick_count >> std::min<size_t>(round_count - 1 - round, 63);
+			std::vector<ScoredSummary> scored(candidates.size());
+			thread_pool.parallelFor(candidates.size(), [&](size_t index, size_t) {
+				AOS_T aos = _factory_method(combinations[candidates[index]]);
+				TradingSummary summary = _strategy_tester_ptr->runSummary(aos, 0, end);
+				scored[index] = ScoredSummary{ score(objective, summary), candidates[index], summary };
+				});
+
+			std::sort(scored.begin(), scored.end(), isBetter);
+			size_t survivor_count = (scored.size() + reduction_factor - 1) / reduction_factor;
+			candidates.clear();
+			for (size_t i = 0; i < survivor_count; ++i) {
+				candidates.push_back(scored[i].combination_index);
+			}
+		}
+
+		return rerun(combinations, candidates.front());
+	}
+
+	/**
+	 * @brief Tests all combinations of parameters comparing only their summaries and returns the best one.
+	 * @note Only the small summaries are passed through the reduction, the full results are materialized
+	 * by running the winner again.
+	 * @tparam ExPo Execution policy type.
+	 * @param expo The execution policy to use.
+	 * @param combinations Combinations of parameters to test.
+	 * @param objective The objective to maximize.
+	 * @return pair of the best trading results and the best parameters.
+	 */
+	template <class ExPo = std::execution::parallel_policy>
+	std::pair<TradingResults, Param_T> findBestParametersSummarized(
+		ExPo&& expo,
+		const std::vector<Param_T>& combinations,
+		ObjectivePtr objective = finalBalance) {
+		if (combinations.empty()) {
+			return std::pair<TradingResults, Param_T>();
+		}
+
+		std::vector<size_t> indexes(combinations.size());
+		std::iota(indexes.begin(), indexes.end(), 0);
+		ScoredSummary best = std::transform_reduce(
+			expo,
+			indexes.begin(),
+			indexes.end(),
+			ScoredSummary(),
+			[](const ScoredSummary& a, const ScoredSummary& b) { return isBetter(a, b) ? a : b; },
+			[this, &combinations, objective](size_t index) {
+				TradingSummary summary = runSummary(combinations, index);
+				return ScoredSummary{ score(objective, summary), index, summary };
+			});
+
+		return rerun(combinations, best.combination_index);
+	}
+
+	/**
+	 * @brief Tests all combinations of parameters in batches of robots that go through the ticks together
+	 * (see StrategyTester::runBatch) and returns the best one.
+	 * @tparam ExPo Execution policy type.
+	 * @param expo The execution policy to use - the batches are run in parallel.
+	 * @param combinations Combinations of parameters to test.
+	 * @param batch_size Count of robots in one batch.
+	 * @return pair of the best trading results and the best parameters.
+	 */
+	template <class ExPo = std::execution::parallel_policy>
+	std::pair<TradingResults, Param_T> findBestParametersBatched(
+		ExPo&& expo,
+		const std::vector<Param_T>& combinations,
+		size_t batch_size = DEFAULT_BATCH_SIZE) {
+		std::vector<size_t> batch_begins;
+		for (size_t begin = 0; begin < combinations.size(); begin += std::max<size_t>(batch_size, 1)) {
+			batch_begins.push_back(begin);
+		}
+
+		// lambda for running a batch of parameters and picking its best results parameter pair
+		auto transform = [
+			&combinations,
+			batch_size = std::max<size_t>(batch_size, 1),
+			_strategy_tester_ptr = this->_strategy_tester_ptr,
+			_factory_method = this->_factory_method]
+			(size_t begin) {
+			size_t end = std::min(begin + batch_size, combinations.size());
+			std::vector<AOS_T> robots;
+			robots.reserve(end - begin);
+			std::vector<ATS*> robot_ptrs;
+			for (size_t i = begin; i < end; ++i) {
+				robot_ptrs.push_back(&robots.emplace_back(_factory_method(combinations[i])));
+			}
+
+			std::vector<TradingResults> results = _strategy_tester_ptr->runBatch(robot_ptrs);
+			std::pair<TradingResults, Param_T> best(std::move(results[0]), combinations[begin]);
+			for (size_t i = 1; i < results.size(); ++i) {
+				if (!(best.first.account_balance > results[i].account_balance)) {
+					best = std::make_pair(std::move(results[i]), combinations[begin + i]);
+				}
+			}
+
+			return best;
+			};
+
+		// lambda for reducing the results parameter pairs
+		auto reduce = [](std::pair<TradingResults, Param_T> a, std::pair<TradingResults, Param_T> b) {
+			return a.first.account_balance > b.first.account_balance ? a : b;
+			};
+
+		return std::transform_reduce(
+			expo,
+			batch_begins.begin(),
+			batch_begins.end(),
+			std::pair<TradingResults, Param_T>(),
+			reduce,
+			transform);
+	}
+
 	/**
 	 * @brief Finds the best parameters in a parallel manner.
 	 * @param combinations Combinations of parameters to test.
@@ -88,6 +669,119 @@ public:
 	}
 
 private:
+	/**
+	 * @brief Default count of robots going through the ticks together.
+	 */
+	static constexpr size_t DEFAULT_BATCH_SIZE = 16;
+
+	/**
+	 * @brief Default largest count of combinations in the Pareto front.
+	 */
+	static constexpr size_t DEFAULT_PARETO_CAPACITY = 64;
+
+	/**
+	 * @brief Default count of the successive halving rounds - the first one runs on 1/32 of the ticks.
+	 */
+	static constexpr size_t DEFAULT_HALVING_ROUNDS = 6;
+
+	/**
+	 * @brief Default ratio of the tested and the surviving combinations of a successive halving round.
+	 */
+	static constexpr size_t DEFAULT_HALVING_REDUCTION = 4;
+
+	/**
+	 * @brief Half of the edge of the box sampled by the first refinement wave, in the unit coordinates.
+	 */
+	static constexpr double INITIAL_REFINEMENT_RADIUS = 0.25;
+
+	/**
+	 * @brief Count of the proposed points per requested one, before a wave gives up finding untested values.
+	 */
+	static constexpr size_t MAX_SAMPLE_ATTEMPTS = 16;
+
+	/**
+	 * @brief Runs the robots with all the combinations on the thread pool without recording their trades.
+	 * @param thread_pool The thread pool to use.
+	 * @param combinations Combinations of parameters to test.
+	 * @param cost_method Optional method predicting the cost of the combinations - the expensive ones are started first.
+	 * @param abort_rules Optional rules aborting the simulations.
+	 * @param visit Called on the worker with the worker id, index of the combination and its summary.
+	 */
+	template <typename Visit>
+	void runOnThreadPool(
+		ThreadPool& thread_pool,
+		const std::vector<Param_T>& combinations,
+		CostMethodPtr cost_method,
+		const AbortRules* abort_rules,
+		Visit visit) {
+		std::vector<size_t> order(combinations.size());
+		std::iota(order.begin(), order.end(), 0);
+		if (cost_method != nullptr) {
+			std::vector<double> costs(combinations.size());
+			std::transform(combinations.begin(), combinations.end(), costs.begin(), cost_method);
+			std::stable_sort(order.begin(), order.end(), [&costs](size_t a, size_t b) { return costs[a] > costs[b]; });
+		}
+
+		thread_pool.parallelFor(order.size(), [&](size_t index, size_t worker_id) {
+			visit(worker_id, order[index], runSummary(combinations, order[index], abort_rules));
+			});
+	}
+
+	/**
+	 * @brief Runs the robot with the combination on the given index without recording its trades.
+	 */
+	TradingSummary runSummary(const std::vector<Param_T>& combinations, size_t index, const AbortRules* abort_rules = nullptr) const {
+		AOS_T aos = _factory_method(combinations[index]);
+		return abort_rules != nullptr
+			? _strategy_tester_ptr->runSummary(aos, *abort_rules)
+			: _strategy_tester_ptr->runSummary(aos);
+	}
+
+	/**
+	 * @brief Chains the out-of-sample results of the windows into one equity curve and summary.
+	 */
+	static void stitch(WalkForwardResults& results) {
+		if (results.windows.empty()) {
+			return;
+		}
+
+		TradingSummary& summary = results.summary;
+		summary.initial_balance = results.windows.front().out_of_sample.summary.initial_balance;
+		double balance = summary.initial_balance;
+		double peak_balance = balance;
+		results.equity.push_back(balance);
+		for (const WalkForwardWindow& window : results.windows) {
+			const TradingSummary& window_summary = window.out_of_sample.summary;
+			for (const Trade& trade : window.out_of_sample.trades) {
+				balance += trade.calculateProfit();
+				results.equity.push_back(balance);
+				peak_balance = std::max(peak_balance, balance);
+				summary.max_drawdown = std::max(summary.max_drawdown, peak_balance - balance);
+			}
+
+			summary.max_drawdown = std::max(summary.max_drawdown, window_summary.max_drawdown);
+			summary.trade_count += window_summary.trade_count;
+			summary.winning_trade_count += window_summary.winning_trade_count;
+			summary.gross_profit += window_summary.gross_profit;
+			summary.gross_loss += window_summary.gross_loss;
+			summary.sum_of_returns += window_summary.sum_of_returns;
+			summary.sum_of_squared_returns += window_summary.sum_of_squared_returns;
+			summary.total_equity = summary.account_balance + window_summary.total_equity - window_summary.initial_balance;
+			summary.account_balance += window_summary.account_balance - window_summary.initial_balance;
+		}
+
+		summary.account_balance += summary.initial_balance;
+		summary.total_equity += summary.initial_balance;
+	}
+
+	/**
+	 * @brief Runs the robot with the combination on the given index again to get its full results.
+	 */
+	std::pair<TradingResults, Param_T> rerun(const std::vector<Param_T>& combinations, size_t index) const {
+		AOS_T aos = _factory_method(combinations[index]);
+		return std::make_pair(_strategy_tester_ptr->run(aos), combinations[index]);
+	}
+
 	StrategyTester* _strategy_tester_ptr;
 	FactoryMethodPtr _factory_method;
 
@@ -1,7 +1,14 @@
 module;
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
 #include <iterator>
+#include <utility>
+#include <vector>
+#include <mutex>
+#include <span>
+#include <limits>
 
 export module StrategyTester;
 
@@ -9,6 +16,7 @@ import AlgoTrading;
 import SimulatedBrokerConnection;
 import TradingManager;
 import MarketDataManager;
+import Objectives;
 
 export namespace Backtesting {
 	using namespace BackTesting;
@@ -48,14 +56,98 @@ export namespace Backtesting {
 	*/
 	using AccountProperties = BackTesting::AccountProperties;
 
+	/**
+	 * @brief Represents the summary statistics of the trading
+	*/
+	using TradingSummary = BackTesting::TradingSummary;
+
+	/**
+	 * @brief Rules aborting hopeless simulations early, they are checked on every simulated tick.
+	 */
+	struct AbortRules {
+		/**
+		 * @brief Largest allowed decline of the equity from its peak (in the account currency).
+		 */
+		double max_drawdown = std::numeric_limits<double>::infinity();
+
+		/**
+		 * @brief Count of trades that have to be closed by the deadline.
+		 */
+		size_t min_trade_count = 0;
+		TimePoint min_trades_deadline;
+
+		/**
+		 * @brief Optimistic estimate of the final score from the summary so far - the simulation is aborted
+		 * when it falls below the score bound. It has to be an upper bound of the final score (e.g. lowMaxDrawdown,
+		 * the drawdown can only grow), otherwise a simulation that would get into the top-K might be aborted.
+		 */
+		ObjectivePtr optimistic_score = nullptr;
+		const SharedScoreBound* score_bound = nullptr;
+
+		/**
+		 * @brief Checks whether the simulation should be aborted.
+		 * @param summary summary of the trading so far.
+		 * @param now time of the current tick.
+		 * @return True if the simulation should be aborted.
+		 */
+		bool shouldAbort(const TradingSummary& summary, TimePoint now) const {
+			if (summary.max_drawdown > max_drawdown) {
+				return true;
+			}
+
+			if (min_trade_count > 0 && now >= min_trades_deadline && summary.trade_count < min_trade_count) {
+				return true;
+			}
+
+			return optimistic_score != nullptr
+				&& score_bound != nullptr
+				&& score(optimistic_score, summary) < score_bound->get();
+		}
+	};
+
+	/**
+	* @brief Handles the tick in the simulation - the trading manager and then the robot process it, and the abort rules are checked.
+	* @note It is shared by StrategyTester and PortfolioTester.
+	* @param trading_manager Trading manager to use in simulation.
+	* @param robot the robot to simulate.
+	* @param tick the tick to handle.
+	* @param abort_rules Optional rules aborting the simulation.
+	* @param symbol index of the symbol of the tick.
+	* @return true if the simulation should continue, false otherwise.
+	*/
+	bool handleTick(TradingManager& trading_manager, ATS& robot, const Tick& tick, const AbortRules* abort_rules = nullptr, size_t symbol = 0) {
+		switch (trading_manager.onTick(tick, symbol))
+		{
+		case AccountState::MARGIN_CALL_WARNING:
+			robot.onMarginCallWarning();
+			break;
+		case AccountState::NONPOSITIVE_ACCOUNT_BALANCE:
+			return false;
+		}
+
+		if (robot.onTick(tick) == ATS::ReturnCode::STOP) {
+			return false;
+		}
+
+		if (abort_rules != nullptr && abort_rules->shouldAbort(trading_manager.getSummary(), tick.timestamp)) {
+			trading_manager.markPruned();
+			return false;
+		}
+
+		return true;
+	}
+
 	/**
 	 * @brief Class that simulates the trading of a strategy
+	 * @note The ticks are kept in columns, so the scans of the timestamps (the simulation schedule,
+	 * the tick-to-bar indexes, the time ranges) and the calculation of bars do not read the other properties.
+	 * The robots get the ticks assembled from the columns.
 	*/
 	class StrategyTester {
 	public:
 		/**
 		 * @brief Construct a Strategy Tester object
-		 * @param ticks_ptr ticks to use in simulation.
+		 * @param ticks_ptr ticks to use in simulation, they are copied into columns.
 		 * @param period the period of the simulation.
 		 * @param account_properties the account properties to use in simulation.
 		 */
@@ -63,11 +155,71 @@ export namespace Backtesting {
 			Ticks* ticks_ptr,
 			SimulationPeriod period,
 			AccountProperties&& account_properties) :
-			_ticks_ptr(ticks_ptr),
-			_market_data_manager(*ticks_ptr),
+			StrategyTester(TicksView(*ticks_ptr), period, std::move(account_properties)) {}
+
+		/**
+		 * @brief Construct a Strategy Tester object over a read-only view of ticks
+		 * (e.g. a memory mapped tick cache).
+		 * @param ticks ticks to use in simulation, they are copied into columns in a single pass.
+		 * @param period the period of the simulation.
+		 * @param account_properties the account properties to use in simulation.
+		 */
+		StrategyTester(
+			TicksView ticks,
+			SimulationPeriod period,
+			AccountProperties&& account_properties) :
+			StrategyTester(TickColumns(ticks), period, std::move(account_properties)) {}
+
+		/**
+		 * @brief Construct a Strategy Tester object over ticks stored in columns.
+		 * @param tick_columns ticks to use in simulation.
+		 * @param period the period of the simulation.
+		 * @param account_properties the account properties to use in simulation.
+		 */
+		StrategyTester(
+			TickColumns&& tick_columns,
+			SimulationPeriod period,
+			AccountProperties&& account_properties) :
+			_tick_columns(std::move(tick_columns)),
+			_market_data_manager(_tick_columns),
 			_period(period),
 			_account_properties(account_properties) {}
 
+		/**
+		 * @brief Construct a Strategy Tester object without in-memory ticks - for runs on a TickSource.
+		 * @param period the period of the simulation.
+		 * @param account_properties the account properties to use in simulation.
+		 */
+		StrategyTester(
+			SimulationPeriod period,
+			AccountProperties&& account_properties) :
+			StrategyTester(TickColumns(), period, std::move(account_properties)) {}
+
+		/**
+		 * @brief Calculates bars of the given timeframes and the simulation schedule in advance.
+		 * @note Call it before running robots in parallel (e.g. by StrategyOptimizer), so the warm-up
+		 * uses all the cores and no run stalls on the first creation of bars.
+		 * @param timeframes the timeframes used by the simulated robots.
+		 */
+		void precomputeBars(std::span<const Timeframe> timeframes) {
+			_market_data_manager.precomputeBars(timeframes);
+			if (_period != SimulationPeriod::TICK) {
+				getSchedule(_period);
+			}
+		}
+
+		/**
+		 * @brief Calculates series of the indicator with the given periods in advance.
+		 * @note Call it before running robots in parallel with all the periods the robots request,
+		 * so the EMA series are calculated together by the multi-period kernel and the others in parallel.
+		 * @param indicator the indicator used by the simulated robots.
+		 * @param timeframe the timeframe of the bars of the indicator.
+		 * @param periods the periods used by the simulated robots.
+		 */
+		void precomputeIndicators(Indicator indicator, Timeframe timeframe, std::span<const size_t> periods) {
+			_market_data_manager.precomputeIndicators(indicator, timeframe, periods);
+		}
+
 		/**
 		 * @brief Runs the simulation of the strategy
 		 * @param robot Robot to simulate.
@@ -75,38 +227,252 @@ export namespace Backtesting {
 		 */
 		TradingResults run(ATS& robot) {
 			TradingManager trading_manager(_account_properties);
-			SimulatedBrokerConnection broker_connection(&trading_manager, &_market_data_manager);
+			simulate(trading_manager, robot);
+			return trading_manager.end();
+		}
 
-			if (robot.start(&broker_connection) == ATS::ReturnCode::STOP) {
-				return trading_manager.end();
+		/**
+		 * @brief Runs the simulation of the strategy without recording the trades.
+		 * @note Use it when only the statistics are compared (e.g. by StrategyOptimizer), the full results
+		 * can be obtained by running the robot again.
+		 * @param robot Robot to simulate.
+		 * @return Summary of the robot's trading.
+		 */
+		TradingSummary runSummary(ATS& robot) {
+			TradingManager trading_manager(_account_properties, false);
+			simulate(trading_manager, robot);
+			return trading_manager.getSummary();
+		}
+
+		/**
+		 * @brief Runs the simulation of the strategy without recording the trades, the simulation is aborted
+		 * as soon as one of the rules matches.
+		 * @param robot Robot to simulate.
+		 * @param abort_rules Rules aborting the simulation.
+		 * @return Summary of the robot's trading, it is marked as pruned if the simulation was aborted.
+		 */
+		TradingSummary runSummary(ATS& robot, const AbortRules& abort_rules) {
+			TradingManager trading_manager(_account_properties, false);
+			simulate(trading_manager, robot, &abort_rules);
+			return trading_manager.getSummary();
+		}
+
+		/**
+		 * @brief Runs the simulation of the strategy on a range of the ticks.
+		 * @note The bars before the range are available to the robot, so it can warm up its indicators.
+		 * @param robot Robot to simulate.
+		 * @param begin index of the first simulated tick.
+		 * @param end index after the last simulated tick, it is clamped to the count of the ticks.
+		 * @return Results of the robot's trading.
+		 */
+		TradingResults run(ATS& robot, size_t begin, size_t end) {
+			TradingManager trading_manager(_account_properties);
+			simulate(trading_manager, robot, nullptr, begin, end);
+			return trading_manager.end();
+		}
+
+		/**
+		 * @brief Runs the simulation of the strategy on a range of the ticks without recording the trades.
+		 * @param robot Robot to simulate.
+		 * @param begin index of the first simulated tick.
+		 * @param end index after the last simulated tick, it is clamped to the count of the ticks.
+		 * @return Summary of the robot's trading.
+		 */
+		TradingSummary runSummary(ATS& robot, size_t begin, size_t end) {
+			TradingManager trading_manager(_account_properties, false);
+			simulate(trading_manager, robot, nullptr, begin, end);
+			return trading_manager.getSummary();
+		}
+
+		/**
+		 * @brief Runs the simulation of the strategy on the ticks in the time range [from, to).
+		 * @note The range is located by binary search over the timestamps and the simulation goes through
+		 * a span of the shared ticks, nothing is copied. The bars before the range are available to the robot.
+		 * @param robot Robot to simulate.
+		 * @param from time of the first simulated tick.
+		 * @param to time after the last simulated tick.
+		 * @return Results of the robot's trading.
+		 */
+		TradingResults run(ATS& robot, TimePoint from, TimePoint to) {
+			auto [begin, end] = findTickRange(from, to);
+			return run(robot, begin, end);
+		}
+
+		/**
+		 * @brief Runs the simulation of the strategy on the ticks in the time range [from, to) without recording the trades.
+		 * @param robot Robot to simulate.
+		 * @param from time of the first simulated tick.
+		 * @param to time after the last simulated tick.
+		 * @return Summary of the robot's trading.
+		 */
+		TradingSummary runSummary(ATS& robot, TimePoint from, TimePoint to) {
+			auto [begin, end] = findTickRange(from, to);
+			return runSummary(robot, begin, end);
+		}
+
+		/**
+		 * @brief Finds indexes of the ticks in the time range [from, to) by binary search over the timestamps.
+		 * @param from time of the first tick.
+		 * @param to time after the last tick.
+		 * @return index of the first tick and index after the last tick of the range.
+		 */
+		std::pair<size_t, size_t> findTickRange(TimePoint from, TimePoint to) const {
+			const std::vector<TimePoint>& timestamps = _tick_columns.timestamps;
+			auto first = std::lower_bound(timestamps.begin(), timestamps.end(), from);
+			auto last = std::lower_bound(first, timestamps.end(), std::max(from, to));
+			return { static_cast<size_t>(first - timestamps.begin()), static_cast<size_t>(last - timestamps.begin()) };
+		}
+
+		/**
+		 * @brief Gets count of the ticks the tester simulates on.
+		 * @return the count of the ticks.
+		 */
+		size_t getTickCount() const {
+			return _tick_columns.size();
+		}
+
+		/**
+		 * @brief Runs the simulations of several robots together in one pass over the ticks.
+		 * @note Every robot has its own trading manager and broker connection, the robots go through
+		 * the same chunk of ticks one after another while the chunk is in the cache, so the ticks are
+		 * read from the memory once per batch instead of once per robot. The results are identical to running
+		 * the robots one by one.
+		 * @param robots Robots to simulate.
+		 * @return Results of the robots' trading in the order of the robots.
+		 */
+		std::vector<TradingResults> runBatch(std::span<ATS* const> robots) {
+			std::deque<BatchedRun> runs;
+			for (ATS* robot : robots) {
+				BatchedRun& run = runs.emplace_back(_account_properties, &_market_data_manager, robot);
+				run.is_started = robot->start(&run.broker_connection) != ATS::ReturnCode::STOP;
+				run.is_running = run.is_started;
 			}
 
-			// TODO: Use the SimulationPeriod
 			if (_period == SimulationPeriod::TICK) {
-				goThroughTicks(trading_manager, robot);
+				goThroughTicksInLockstep(runs, _tick_columns.size(), [](size_t position) { return position; });
 			}
 			else {
-				goThroughTicks(_period, trading_manager, robot);
+				const std::vector<size_t>& schedule = getSchedule(_period);
+				goThroughTicksInLockstep(runs, schedule.size(), [&schedule](size_t position) { return schedule[position]; });
+			}
+
+			std::vector<TradingResults> results;
+			results.reserve(runs.size());
+			for (BatchedRun& run : runs) {
+				if (run.is_started) {
+					run.robot->end();
+				}
+
+				results.push_back(run.trading_manager.end());
+			}
+
+			return results;
+		}
+
+		/**
+		 * @brief Runs the simulation of the strategy on ticks pulled from the given source.
+		 * @note Bars are built incrementally from the pulled ticks, so the memory is bounded by the bar history
+		 * and the tester does not need to hold any ticks.
+		 * @param robot Robot to simulate.
+		 * @param tick_source Source of the ticks to simulate on.
+		 * @return Results of the robot's trading.
+		 */
+		TradingResults run(ATS& robot, TickSource& tick_source) {
+			MarketDataManager market_data_manager;
+			TradingManager trading_manager(_account_properties);
+			SimulatedBrokerConnection broker_connection(&trading_manager, &market_data_manager);
+
+			if (robot.start(&broker_connection) == ATS::ReturnCode::STOP) {
+				return trading_manager.end();
 			}
 
+			goThroughTicks(tick_source, market_data_manager, trading_manager, robot);
+
 			robot.end();
 			return trading_manager.end();
 		}
 
 	private:
-		Ticks* _ticks_ptr;
+		/**
+		 * @brief Count of ticks the robots of a batch go through before moving to the next chunk,
+		 * the chunk (about 40 kB of ticks) stays in the L1/L2 cache while it is reused by the robots.
+		 */
+		static constexpr size_t BATCH_TICK_CHUNK = 1024;
+
+		/**
+		 * @brief State of one robot's simulation in a batch.
+		 */
+		struct BatchedRun {
+			TradingManager trading_manager;
+			SimulatedBrokerConnection broker_connection;
+			ATS* robot;
+			bool is_started = false;
+			bool is_running = false;
+
+			BatchedRun(const AccountProperties& account_properties, MarketDataManager* market_data_manager_ptr, ATS* robot) :
+				trading_manager(account_properties),
+				broker_connection(&trading_manager, market_data_manager_ptr),
+				robot(robot) {}
+		};
+
+		TickColumns _tick_columns;
 		MarketDataManager _market_data_manager;
 		SimulationPeriod _period;
 		AccountProperties _account_properties;
+		std::vector<size_t> _schedule;
+		std::once_flag _schedule_flag;
+
+		/**
+		 * @brief Simulates the robot trading through the trading manager.
+		 * @param trading_manager Trading manager to use in simulation.
+		 * @param robot the robot to simulate.
+		 * @param abort_rules Optional rules aborting the simulation.
+		 * @param begin index of the first simulated tick.
+		 * @param end index after the last simulated tick.
+		 */
+		void simulate(
+			TradingManager& trading_manager,
+			ATS& robot,
+			const AbortRules* abort_rules = nullptr,
+			size_t begin = 0,
+			size_t end = std::numeric_limits<size_t>::max()) {
+			end = std::min(end, _tick_columns.size());
+			begin = std::min(begin, end);
+			SimulatedBrokerConnection broker_connection(&trading_manager, &_market_data_manager);
+
+			if (robot.start(&broker_connection) == ATS::ReturnCode::STOP) {
+				return;
+			}
+
+			if (_period == SimulationPeriod::TICK) {
+				goThroughTicks(trading_manager, broker_connection, robot, abort_rules, begin, end);
+			}
+			else {
+				goThroughTicks(_period, trading_manager, broker_connection, robot, abort_rules, begin, end);
+			}
+
+			robot.end();
+		}
 
 		/**
 		 * @brief Goes through the ticks and simulates the trading tick by tick.
 		 * @param trading_manager Trading manager to use in simulation.
+		 * @param broker_connection Broker connection of the robot.
 		 * @param robot the robot to simulate.
+		 * @param abort_rules Optional rules aborting the simulation.
+		 * @param begin index of the first simulated tick.
+		 * @param end index after the last simulated tick.
 		 */
-		void goThroughTicks(TradingManager& trading_manager, ATS& robot) {
-			for (const auto& tick : *_ticks_ptr) {
-				if (!handleTick(trading_manager, robot, tick)) {
+		void goThroughTicks(
+			TradingManager& trading_manager,
+			SimulatedBrokerConnection& broker_connection,
+			ATS& robot,
+			const AbortRules* abort_rules,
+			size_t begin,
+			size_t end) {
+			for (size_t tick_index = begin; tick_index < end; ++tick_index) {
+				broker_connection.setCurrentTickIndex(tick_index);
+				if (!handleTick(trading_manager, robot, _tick_columns[tick_index], abort_rules)) {
 					break;
 				}
 			}
@@ -116,44 +482,115 @@ export namespace Backtesting {
 		 * @brief Goes through the ticks and simulates the trading with the specified period.
 		 * @param period How much ticks to skip.
 		 * @param trading_manager Trading manager to use in simulation.
+		 * @param broker_connection Broker connection of the robot.
 		 * @param robot the robot to simulate.
+		 * @param abort_rules Optional rules aborting the simulation.
+		 * @param begin index of the first simulated tick.
+		 * @param end index after the last simulated tick.
 		 */
-		void goThroughTicks(SimulationPeriod period, TradingManager& trading_manager, ATS& robot) {
-			TimePoint wait_for_timestamp = _ticks_ptr->front().timestamp;
-			for (const auto& tick : *_ticks_ptr) {
-				if (tick.timestamp < wait_for_timestamp) {
-					continue;
-				}
-
-				wait_for_timestamp += timeframe_durations[(int)period];
-				if (!handleTick(trading_manager, robot, tick)) {
+		void goThroughTicks(
+			SimulationPeriod period,
+			TradingManager& trading_manager,
+			SimulatedBrokerConnection& broker_connection,
+			ATS& robot,
+			const AbortRules* abort_rules,
+			size_t begin,
+			size_t end) {
+			const std::vector<size_t>& schedule = getSchedule(period);
+			auto first = std::lower_bound(schedule.begin(), schedule.end(), begin);
+			auto last = std::lower_bound(first, schedule.end(), end);
+			for (size_t tick_index : std::span(first, last)) {
+				broker_connection.setCurrentTickIndex(tick_index);
+				if (!handleTick(trading_manager, robot, _tick_columns[tick_index], abort_rules)) {
 					break;
 				}
 			}
 		}
 
 		/**
-		* @brief Handles the tick in the simulation.
-		* @param trading_manager Trading manager to use in simulation.
-		* @param robot the robot to simulate.
-		* @param tick the tick to handle.
-		* @return true if the simulation should continue, false otherwise.
-		*/
-		bool handleTick(TradingManager& trading_manager, ATS& robot, const Tick& tick) {
-			switch (trading_manager.onTick(tick))
-			{
-			case AccountState::MARGIN_CALL_WARNING:
-				robot.onMarginCallWarning();
-				break;
-			case AccountState::NONPOSITIVE_ACCOUNT_BALANCE:
-				return false;
+		 * @brief Goes through the simulated ticks chunk by chunk, every running robot handles the whole chunk
+		 * before the next robot does.
+		 * @param runs Simulations of the robots in the batch.
+		 * @param count Count of the simulated ticks.
+		 * @param tick_index_at Maps position among the simulated ticks to the index of the tick.
+		 */
+		template <typename TickIndexAt>
+		void goThroughTicksInLockstep(std::deque<BatchedRun>& runs, size_t count, TickIndexAt tick_index_at) {
+			for (size_t begin = 0; begin < count; begin += BATCH_TICK_CHUNK) {
+				size_t end = std::min(begin + BATCH_TICK_CHUNK, count);
+				for (BatchedRun& run : runs) {
+					for (size_t position = begin; run.is_running && position < end; ++position) {
+						size_t tick_index = tick_index_at(position);
+						run.broker_connection.setCurrentTickIndex(tick_index);
+						run.is_running = handleTick(run.trading_manager, *run.robot, _tick_columns[tick_index]);
+					}
+				}
 			}
+		}
 
-			if (robot.onTick(tick) == ATS::ReturnCode::STOP) {
-				return false;
-			}
+		/**
+		 * @brief Gets indexes of the ticks that are simulated with the given period.
+		 * @note The schedule does not depend on the robot, so it is computed by a single scan of the timestamp column
+		 * on the first run and all the following (possibly concurrent) runs only walk the selected ticks.
+		 * @param period the period of the simulation.
+		 * @return indexes of the simulated ticks.
+		 */
+		const std::vector<size_t>& getSchedule(SimulationPeriod period) {
+			std::call_once(_schedule_flag, [this, period]() {
+				const std::vector<TimePoint>& timestamps = _tick_columns.timestamps;
+				if (timestamps.empty()) {
+					return;
+				}
+
+				TimePoint wait_for_timestamp = timestamps.front();
+				for (size_t i = 0; i < timestamps.size(); ++i) {
+					if (timestamps[i] < wait_for_timestamp) {
+						continue;
+					}
+
+					wait_for_timestamp += timeframe_durations[(int)period];
+					_schedule.push_back(i);
+				}
+				});
 
-			return true;
+			return _schedule;
+		}
+
+		/**
+		 * @brief Goes through the ticks pulled from the source and simulates the trading with the tester's period.
+		 * @param tick_source Source of the ticks.
+		 * @param market_data_manager Market data manager building the bars from the pulled ticks.
+		 * @param trading_manager Trading manager to use in simulation.
+		 * @param robot the robot to simulate.
+		 */
+		void goThroughTicks(
+			TickSource& tick_source,
+			MarketDataManager& market_data_manager,
+			TradingManager& trading_manager,
+			ATS& robot) {
+			bool first_tick = true;
+			TimePoint wait_for_timestamp;
+			for (TicksView chunk = tick_source.next(); !chunk.empty(); chunk = tick_source.next()) {
+				for (const auto& tick : chunk) {
+					market_data_manager.addTick(tick);
+					if (_period != SimulationPeriod::TICK) {
+						if (first_tick) {
+							wait_for_timestamp = tick.timestamp;
+							first_tick = false;
+						}
+
+						if (tick.timestamp < wait_for_timestamp) {
+							continue;
+						}
+
+						wait_for_timestamp += timeframe_durations[(int)_period];
+					}
+
+					if (!handleTick(trading_manager, robot, tick)) {
+						return;
+					}
+				}
+			}
 		}
 	};
 };
@@ -0,0 +1,209 @@
+module;
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+export module ThreadPool;
+
+namespace Backtesting {
+
+/**
+ * @brief Pool of worker threads running indexed jobs with work stealing.
+ * @note Jobs are dealt to the workers' queues round-robin in the order of their indexes, every worker takes
+ * jobs from the front of its own queue and, once the queue is empty, steals from the back of the others' queues.
+ * So when the jobs are ordered from the most expensive, the expensive jobs start first and the cheap ones
+ * balance the end of the run.
+ */
+export class ThreadPool {
+public:
+	/**
+	 * @brief Represents job run on a worker.
+	 * @param index index of the job
+	 * @param worker_id id of the worker running the job, in range [0, getWorkerCount())
+	 */
+	using Job = std::function<void(size_t index, size_t worker_id)>;
+
+	/**
+	 * @brief Starts the workers.
+	 * @param worker_count count of the worker threads, the hardware concurrency is used if zero.
+	 */
+	explicit ThreadPool(size_t worker_count = 0) {
+		if (worker_count == 0) {
+			worker_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		}
+
+		for (size_t i = 0; i < worker_count; ++i) {
+			_queues.push_back(std::make_unique<WorkerQueue>());
+		}
+
+		for (size_t i = 0; i < worker_count; ++i) {
+			_workers.emplace_back([this, i]() { workerLoop(i); });
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/**
+	 * @brief Stops and joins the workers.
+	 */
+	~ThreadPool() {
+		{
+			std::lock_guard lock(_mutex);
+			_is_stopping = true;
+		}
+
+		_start_condition.notify_all();
+		for (std::thread& worker : _workers) {
+			worker.join();
+		}
+	}
+
+	/**
+	 * @brief Gets count of the worker threads.
+	 * @return the count of the workers.
+	 */
+	size_t getWorkerCount() const {
+		return _workers.size();
+	}
+
+	/**
+	 * @brief Runs the job for all the indexes in [0, count) on the workers and waits for them.
+	 * @note Concurrent calls are serialized. If a job throws, the jobs that have not started yet are skipped
+	 * and the first exception is rethrown.
+	 * @param count count of the jobs
+	 * @param job the job to run
+	 */
+	void parallelFor(size_t count, const Job& job) {
+		std::lock_guard run_lock(_run_mutex);
+		for (size_t index = 0; index < count; ++index) {
+			_queues[index % _queues.size()]->jobs.push_back(index);
+		}
+
+		{
+			std::lock_guard lock(_mutex);
+			_job = &job;
+			_exception = nullptr;
+			_active_workers = _workers.size();
+			++_generation;
+		}
+
+		_start_condition.notify_all();
+		std::unique_lock lock(_mutex);
+		_done_condition.wait(lock, [this]() { return _active_workers == 0; });
+		_job = nullptr;
+		if (_exception) {
+			std::rethrow_exception(_exception);
+		}
+	}
+
+private:
+	/**
+	 * @brief Queue of the job indexes of one worker.
+	 */
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::deque<size_t> jobs;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> _queues;
+	std::vector<std::thread> _workers;
+
+	std::mutex _run_mutex;
+	std::mutex _mutex;
+	std::condition_variable _start_condition;
+	std::condition_variable _done_condition;
+	const Job* _job = nullptr;
+	std::exception_ptr _exception;
+	size_t _generation = 0;
+	size_t _active_workers = 0;
+	bool _is_stopping = false;
+
+	/**
+	 * @brief Takes the next job of the worker - from its own queue or stolen from another one.
+	 * @param worker_id id of the worker
+	 * @param index output parameter - index of the job
+	 * @return True if a job was taken, false if all the queues are empty.
+	 */
+	bool tryTakeJob(size_t worker_id, size_t& index) {
+		for (size_t i = 0; i < _queues.size(); ++i) {
+			bool is_own = i == 0;
+			WorkerQueue& queue = *_queues[(worker_id + i) % _queues.size()];
+			std::lock_guard lock(queue.mutex);
+			if (queue.jobs.empty()) {
+				continue;
+			}
+
+			if (is_own) {
+				index = queue.jobs.front();
+				queue.jobs.pop_front();
+			}
+			else {
+				index = queue.jobs.back();
+				queue.jobs.pop_back();
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief Discards the jobs that have not started yet.
+	 */
+	void clearQueues() {
+		for (auto& queue : _queues) {
+			std::lock_guard lock(queue->mutex);
+			queue->jobs.clear();
+		}
+	}
+
+	void workerLoop(size_t worker_id) {
+		size_t seen_generation = 0;
+		while (true) {
+			const Job* job;
+			{
+				std::unique_lock lock(_mutex);
+				_start_condition.wait(lock, [&]() { return _is_stopping || _generation != seen_generation; });
+				if (_is_stopping) {
+					return;
+				}
+
+				seen_generation = _generation;
+				job = _job;
+			}
+
+			size_t index;
+			while (tryTakeJob(worker_id, index)) {
+				try {
+					(*job)(index, worker_id);
+				}
+				catch (...) {
+					{
+						std::lock_guard lock(_mutex);
+						if (!_exception) {
+							_exception = std::current_exception();
+						}
+					}
+
+					clearQueues();
+				}
+			}
+
+			std::lock_guard lock(_mutex);
+			if (--_active_workers == 0) {
+				_done_condition.notify_one();
+			}
+		}
+	}
+};
+
+}
@@ -6,6 +6,8 @@ module;
 #include <functional>
 #include <utility>
 #include <cassert>
+#include <cmath>
+#include <limits>
 
 export module TradingManager;
 import AlgoTrading;
@@ -38,6 +40,119 @@ namespace BackTesting {
 		float stop_out_warning_level = 0.55;
 	};
 
+	/**
+	 * @brief Represents fixed-size statistics of the trading, they are maintained during the simulation
+	 * so they are available without recording the trades.
+	 */
+	export struct TradingSummary {
+		/**
+		 * @brief Account balance at the end of the simulation.
+		 */
+		double account_balance = 0;
+
+		/**
+		 * @brief Total equity at the end of the simulation.
+		 */
+		double total_equity = 0;
+
+		/**
+		 * @brief Count of closed trades.
+		 */
+		size_t trade_count = 0;
+
+		/**
+		 * @brief Count of closed trades with positive profit.
+		 */
+		size_t winning_trade_count = 0;
+
+		/**
+		 * @brief Largest decline of the equity from its previous peak (in the account currency).
+		 * @note The equity is sampled on the simulated ticks.
+		 */
+		double max_drawdown = 0;
+
+		/**
+		 * @brief Account balance at the start of the simulation.
+		 */
+		double initial_balance = 0;
+
+		/**
+		 * @brief Sum of profits of the winning trades.
+		 */
+		double gross_profit = 0;
+
+		/**
+		 * @brief Sum of losses of the losing trades (positive).
+		 */
+		double gross_loss = 0;
+
+		/**
+		 * @brief Sum and sum of squares of the trade returns (profit relative to the balance before the trade).
+		 */
+		double sum_of_returns = 0;
+		double sum_of_squared_returns = 0;
+
+		/**
+		 * @brief True if the simulation was aborted by an abort rule before the end of the data.
+		 */
+		bool is_pruned = false;
+
+		/**
+		 * @brief Gets the ratio of the winning trades.
+		 * @return ratio of the winning trades, zero if there are no trades.
+		 */
+		double getWinRate() const {
+			return trade_count == 0 ? 0 : static_cast<double>(winning_trade_count) / trade_count;
+		}
+
+		/**
+		 * @brief Gets the relative change of the balance.
+		 * @return the return of the simulation.
+		 */
+		double getReturn() const {
+			return initial_balance == 0 ? 0 : (account_balance - initial_balance) / initial_balance;
+		}
+
+		/**
+		 * @brief Gets the ratio of the gross profit and the gross loss.
+		 * @return the profit factor, infinity if there are profits and no losses.
+		 */
+		double getProfitFactor() const {
+			if (gross_loss == 0) {
+				return gross_profit > 0 ? std::numeric_limits<double>::infinity() : 0;
+			}
+
+			return gross_profit / gross_loss;
+		}
+
+		/**
+		 * @brief Gets the Sharpe ratio of the trade returns (mean over standard deviation, without a risk-free rate).
+		 * @return the Sharpe ratio, zero if there are less than two trades or the returns do not vary.
+		 */
+		double getSharpeRatio() const {
+			if (trade_count < 2) {
+				return 0;
+			}
+
+			double mean = sum_of_returns / trade_count;
+			double variance = (sum_of_squared_returns - trade_count * mean * mean) / (trade_count - 1);
+			return variance <= 0 ? 0 : mean / std::sqrt(variance);
+		}
+
+		/**
+		 * @brief Gets the ratio of the profit and the max drawdown.
+		 * @return the return over drawdown, infinity if there is a profit and no drawdown.
+		 */
+		double getReturnToDrawdown() const {
+			double profit = account_balance - initial_balance;
+			if (max_drawdown == 0) {
+				return profit > 0 ? std::numeric_limits<double>::infinity() : 0;
+			}
+
+			return profit / max_drawdown;
+		}
+	};
+
 	/**
 	 * @brief Alias for iterator of the list of positions.
 	 */
@@ -197,6 +312,8 @@ namespace BackTesting {
 
 	/**
 	 * @brief Manager for keeping account state.
+	 * @note The margin is shared by the positions of all the symbols, the unrealized profit of a symbol
+	 * is updated by the ticks of the symbol.
 	 */
 	class AccountBalanceManager {
 	public:
@@ -204,17 +321,20 @@ namespace BackTesting {
 			double account_balance,
 			unsigned int leverage,
 			float stop_out_level,
-			float stop_out_warning_level) noexcept :
+			float stop_out_warning_level,
+			size_t symbol_count = 1) :
 			_account_balance(account_balance),
 			_leverage(leverage),
 			_stop_out_level(stop_out_level),
-			_stop_out_warning_level(stop_out_warning_level) {}
+			_stop_out_warning_level(stop_out_warning_level),
+			_exposures(symbol_count) {}
 
-		AccountBalanceManager(const AccountProperties& properties) noexcept :
+		AccountBalanceManager(const AccountProperties& properties, size_t symbol_count = 1) :
 			_account_balance(properties.account_balance),
 			_leverage(properties.leverage),
 			_stop_out_level(properties.stop_out_level),
-			_stop_out_warning_level(properties.stop_out_warning_level) {}
+			_stop_out_warning_level(properties.stop_out_warning_level),
+			_exposures(symbol_count) {}
 
 		double getBalance() const {
 			return _account_balance;
@@ -265,31 +385,37 @@ namespace BackTesting {
 		}
 
 		void addPosition(const Position& pos) {
+			SymbolExposure& exposure = _exposures[pos.symbol];
 			if (pos.is_long) {
-				_long_volume += pos.volume;
+				exposure.long_volume += pos.volume;
+				exposure.long_positions_expanses += pos.volume * pos.open_price;
 				_long_positions_expanses += pos.volume * pos.open_price;
 			}
 			else {
-				_short_volume += pos.volume;
+				exposure.short_volume += pos.volume;
+				exposure.short_positions_expanses += pos.volume * pos.open_price;
 				_short_positions_expanses += pos.volume * pos.open_price;
 			}
 		}
 
 		void realizePosition(const Trade& trade) {
+			SymbolExposure& exposure = _exposures[trade.symbol];
 			if (trade.is_long) {
-				_long_volume -= trade.volume;
+				exposure.long_volume -= trade.volume;
+				exposure.long_positions_expanses -= trade.volume * trade.open_price;
 				_long_positions_expanses -= trade.volume * trade.open_price;
 			}
 			else {
-				_short_volume -= trade.volume;
+				exposure.short_volume -= trade.volume;
+				exposure.short_positions_expanses -= trade.volume * trade.open_price;
 				_short_positions_expanses -= trade.volume * trade.open_price;
 			}
 
 			_account_balance += trade.calculateProfit();
 		}
 
-		AccountState onTick(const Tick& tick) {
-			updateOpenPositionEquity(tick);
+		AccountState onTick(const Tick& tick, size_t symbol = 0) {
+			updateOpenPositionEquity(tick, symbol);
 			if (_account_balance <= 0) {
 				return AccountState::NONPOSITIVE_ACCOUNT_BALANCE;
 			}
@@ -309,23 +435,38 @@ namespace BackTesting {
 
 
 	private:
+		/**
+		 * @brief Open positions of one symbol and their unrealized profit at the last tick of the symbol.
+		 */
+		struct SymbolExposure {
+			volume long_volume = 0;
+			double long_positions_expanses = 0;
+			volume short_volume = 0;
+			double short_positions_expanses = 0;
+			double open_position_equity = 0;
+		};
+
 		float _stop_out_level;
 		float _stop_out_warning_level;
 		double _account_balance;
 		unsigned int _leverage;
 		double _open_position_equity = 0;
 		double _long_positions_expanses = 0;
-		volume _long_volume = 0;
-
 		double _short_positions_expanses = 0;
-		volume _short_volume = 0;
+		vector<SymbolExposure> _exposures;
 
-		void updateOpenPositionEquity(const Tick& tick) {
+		void updateOpenPositionEquity(const Tick& tick, size_t symbol) {
 			// calculate profits = current_value - expanse
-			double long_profit = tick.bid * _long_volume - _long_positions_expanses;
-			double short_profit = _short_positions_expanses - tick.ask * _short_volume;
-
-			_open_position_equity = long_profit + short_profit;
+			SymbolExposure& exposure = _exposures[symbol];
+			double long_profit = tick.bid * exposure.long_volume - exposure.long_positions_expanses;
+			double short_profit = exposure.short_positions_expanses - tick.ask * exposure.short_volume;
+			exposure.open_position_equity = long_profit + short_profit;
+
+			// the symbols are few, summing them keeps the single symbol equity exact
+			_open_position_equity = _exposures.front().open_position_equity;
+			for (size_t i = 1; i < _exposures.size(); ++i) {
+				_open_position_equity += _exposures[i].open_position_equity;
+			}
 		}
 	};
 
@@ -359,20 +500,51 @@ namespace BackTesting {
 			* @brief Trades made by the end of the simulation.
 			*/
 			Trades trades;
+
+			/**
+			 * @brief Statistics of the trading at the end of the simulation.
+			 */
+			TradingSummary summary;
 		};
 
 		/**
 		 * @brief Constructs a Trading Manager object
 		 * @param properties the account properties to use in simulation.
+		 * @param record_trades whether the closed trades are kept for the results,
+		 * the summary is maintained either way.
+		 * @param symbol_count count of the traded symbols, their positions share the account.
 		 */
-		TradingManager(const AccountProperties& properties): _account_manager(properties) {}
+		TradingManager(const AccountProperties& properties, bool record_trades = true, size_t symbol_count = 1) :
+			_current_ticks(symbol_count),
+			_has_ticks(symbol_count, false),
+			_account_manager(properties, symbol_count),
+			_record_trades(record_trades),
+			_peak_equity(properties.account_balance) {
+			_summary.initial_balance = properties.account_balance;
+			_stoploss_managers.reserve(symbol_count);
+			_takeprofit_managers.reserve(symbol_count);
+			for (size_t symbol = 0; symbol < symbol_count; ++symbol) {
+				_stoploss_managers.emplace_back(function([this](PositionsIterator iter) {
+					_takeprofit_managers[(*iter).symbol].remove(iter);
+					closePosition(iter, Trade::CloseType::STOPLOSS);
+					}));
+				_takeprofit_managers.emplace_back(function([this](PositionsIterator iter) {
+					_stoploss_managers[(*iter).symbol].remove(iter);
+					closePosition(iter, Trade::CloseType::TAKEPROFIT);
+					}));
+			}
+		}
+
+		TradingManager(const TradingManager&) = delete;
+		TradingManager& operator=(const TradingManager&) = delete;
 
 		/**
 		 * @brief Simulates the trading on a given tick.
 		 * @param tick The tick to simulate.
+		 * @param symbol index of the symbol of the tick.
 		 * @return State of the account after the simulation.
 		 */
-		AccountState onTick(const Tick& tick);
+		AccountState onTick(const Tick& tick, size_t symbol = 0);
 
 		/**
 		 * @brief gets the position by id
@@ -423,7 +595,25 @@ namespace BackTesting {
 		 * @return the time of the current tick.
 		 */
 		TimePoint getCurrentTime() const {
-			return _current_tick.timestamp;
+			return _current_ticks[_current_symbol].timestamp;
+		}
+
+		/**
+		 * @brief Gets the summary of the trading so far.
+		 * @note The summary is not copied, so it can be checked on every tick (e.g. by the abort rules).
+		 * @return the trading summary, its balance and equity are those at the time of the call.
+		 */
+		const TradingSummary& getSummary() {
+			_summary.account_balance = _account_manager.getBalance();
+			_summary.total_equity = _account_manager.getTotalEquity();
+			return _summary;
+		}
+
+		/**
+		 * @brief Marks the simulation as aborted before the end of the data.
+		 */
+		void markPruned() {
+			_summary.is_pruned = true;
 		}
 
 		/**
@@ -436,6 +626,7 @@ namespace BackTesting {
 				_account_manager.getTotalEquity(),
 				move(_positions),
 				move(_trades),
+				getSummary(),
 			};
 		}
 		 
@@ -477,39 +668,41 @@ namespace BackTesting {
 		size_t _new_id;
 		Position::List _positions;
 		Trades _trades;
-		Tick _current_tick;
-		unordered_map<Position::Id, PositionsIterator> _position_iterators_by_id;
-		StoplossManager _stoploss_manager = StoplossManager(function([this](PositionsIterator iter) {
-			_takeprofit_manager.remove(iter);
-			closePosition(iter, Trade::CloseType::STOPLOSS);
-			}));
 
-		TakeprofitManager _takeprofit_manager = TakeprofitManager(function([this](PositionsIterator iter) {
-			_stoploss_manager.remove(iter);
-			closePosition(iter, Trade::CloseType::TAKEPROFIT);
-			}));
+		/**
+		 * @brief Last tick of every symbol, the prices of a symbol's positions are taken from its last tick.
+		 */
+		vector<Tick> _current_ticks;
+		vector<bool> _has_ticks;
+		size_t _current_symbol = 0;
+		unordered_map<Position::Id, PositionsIterator> _position_iterators_by_id;
+		vector<StoplossManager> _stoploss_managers;
+		vector<TakeprofitManager> _takeprofit_managers;
 
 		AccountBalanceManager _account_manager;
+		bool _record_trades;
+		TradingSummary _summary;
+		double _peak_equity;
 
 		void unregisterPositionEvents(PositionsIterator iter) {
 			auto& position = *iter;
 			if (position.hasStoploss()) {
-				_stoploss_manager.remove(iter);
+				_stoploss_managers[position.symbol].remove(iter);
 			}
 
 			if (position.hasTakeprofit()) {
-				_takeprofit_manager.remove(iter);
+				_takeprofit_managers[position.symbol].remove(iter);
 			}
 		}
 
 		void registerPositionEvents(PositionsIterator iter) {
 			auto& position = *iter;
 			if (position.hasStoploss()) {
-				_stoploss_manager.add(iter);
+				_stoploss_managers[position.symbol].add(iter);
 			}
 
 			if (position.hasTakeprofit()) {
-				_takeprofit_manager.add(iter);
+				_takeprofit_managers[position.symbol].add(iter);
 			}
 		}
 
@@ -529,14 +722,16 @@ namespace BackTesting {
 		}
 	};
 	
-	AccountState TradingManager::onTick(const Tick& tick) {
-		_current_tick = tick;
+	AccountState TradingManager::onTick(const Tick& tick, size_t symbol) {
+		_current_symbol = symbol;
+		_current_ticks[symbol] = tick;
+		_has_ticks[symbol] = true;
 
 		// Check if any price events should happen (handled by callbacks)
-		_stoploss_manager.onTick(tick);
-		_takeprofit_manager.onTick(tick);
+		_stoploss_managers[symbol].onTick(tick);
+		_takeprofit_managers[symbol].onTick(tick);
 
-		AccountState state = _account_manager.onTick(tick);
+		AccountState state = _account_manager.onTick(tick, symbol);
 		switch (state)
 		{
 		case BackTesting::NONPOSITIVE_ACCOUNT_BALANCE:
@@ -549,6 +744,9 @@ namespace BackTesting {
 			break;
 		}
 
+		double equity = _account_manager.getTotalEquity();
+		_peak_equity = std::max(_peak_equity, equity);
+		_summary.max_drawdown = std::max(_summary.max_drawdown, _peak_equity - equity);
 		return state;
 	}
 	
@@ -569,12 +767,18 @@ namespace BackTesting {
 	* @return True on success, otherwise false - insufficient funds/margin.
 	*/
 	bool TradingManager::tryCreatePosition(const Order& order, Position::Id& pos) {
+		// the symbol has to be known and priced
+		if (order.symbol >= _current_ticks.size() || !_has_ticks[order.symbol]) {
+			return false;
+		}
+
 		// prepare open prices based on order type
-		price open_price = _current_tick.ask;
-		price eventual_close_price = _current_tick.bid;
+		const Tick& tick = _current_ticks[order.symbol];
+		price open_price = tick.ask;
+		price eventual_close_price = tick.bid;
 		if (!order.is_long) {
-			price open_price = _current_tick.bid;
-			price eventual_close_price = _current_tick.ask;
+			open_price = tick.bid;
+			eventual_close_price = tick.ask;
 		}
 
 		// check whether we can process the order
@@ -588,13 +792,14 @@ namespace BackTesting {
 		// process the given order
 		Position& position = _positions.emplace_front(
 			_new_id++,
-			_current_tick.timestamp,
+			getCurrentTime(),
 			open_price,
 			order.volume,
 			order.is_long,
 			order.comment,
 			order.stoploss,
-			order.takeprofit);
+			order.takeprofit,
+			order.symbol);
 
 		auto position_iter = _positions.begin();
 		_position_iterators_by_id[position.id] = position_iter;
@@ -608,21 +813,40 @@ namespace BackTesting {
 	
 	void TradingManager::closePosition(PositionsIterator iter, Trade::CloseType ct) {
 		auto& pos = *iter;
-		auto& trade = _trades.emplace_back(
+		const Tick& tick = _current_ticks[pos.symbol];
+		Trade trade(
 			pos.open_time,
-			_current_tick.timestamp,
+			getCurrentTime(),
 			pos.open_price,
-			(pos.is_long ? _current_tick.bid : _current_tick.ask),
+			(pos.is_long ? tick.bid : tick.ask),
 			pos.volume,
 			pos.is_long,
 			ct,
-			move(pos.comment)
+			move(pos.comment),
+			pos.symbol
 		);
 
+		double balance_before = _account_manager.getBalance();
 		_account_manager.realizePosition(trade);
+		double profit = trade.calculateProfit();
+		double trade_return = balance_before > 0 ? profit / balance_before : 0;
+		++_summary.trade_count;
+		_summary.sum_of_returns += trade_return;
+		_summary.sum_of_squared_returns += trade_return * trade_return;
+		if (profit > 0) {
+			++_summary.winning_trade_count;
+			_summary.gross_profit += profit;
+		}
+		else {
+			_summary.gross_loss -= profit;
+		}
+
+		if (_record_trades) {
+			_trades.push_back(move(trade));
+		}
 
 		auto by_id_iterator = _position_iterators_by_id.find(pos.id);
-		assert(by_id_iterator == _position_iterators_by_id.end());
+		assert(by_id_iterator != _position_iterators_by_id.end());
 
 		_position_iterators_by_id.erase(by_id_iterator);
 		_positions.erase(iter);
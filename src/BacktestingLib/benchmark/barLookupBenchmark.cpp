@@ -0,0 +1,103 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+
+import AlgoTrading;
+import Backtesting;
+
+using namespace std;
+
+/**
+ * @brief Generates one tick per second with a slowly oscillating price.
+ * @param count count of the ticks.
+ * @return generated ticks.
+ */
+Ticks generateTicks(size_t count) {
+	auto start = std::chrono::floor<std::chrono::hours>(std::chrono::system_clock::now());
+	Ticks ticks;
+	ticks.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		price bid = 1.0 + (i % 600) * 0.00001;
+		ticks.push_back({ start + std::chrono::seconds(i), bid, bid + 0.0002, 1, ChangeFlag::ASK_AND_BID });
+	}
+
+	return ticks;
+}
+
+/**
+ * @brief Index of the last bar opened not later than the given time as found before by a linear scan.
+ * @param bars bars ordered by their open timestamps.
+ * @param tp the time.
+ * @return index of the bar or -1 if all the bars are opened later.
+ */
+int findLinearly(const Bars& bars, TimePoint tp) {
+	for (size_t i = 0; i < bars.size(); ++i) {
+		if (bars[i].open_timestamp > tp) {
+			return (int)i - 1;
+		}
+	}
+
+	return (int)bars.size() - 1;
+}
+
+/**
+ * @brief Looks up the last bars before every sampled tick, as a robot does during a simulation.
+ * @param ticks simulated ticks.
+ * @param step every step-th tick is used.
+ * @param lookup the measured lookup, returns false if the bars were not found.
+ * @return average duration of one lookup in nanoseconds.
+ */
+template <typename Lookup>
+double measure(const Ticks& ticks, size_t step, Lookup lookup) {
+	using namespace std::chrono;
+
+	size_t calls = 0;
+	size_t found = 0;
+	auto start = steady_clock::now();
+	for (size_t i = 1; i < ticks.size(); i += step) {
+		found += lookup(ticks[i].timestamp) ? 1 : 0;
+		++calls;
+	}
+
+	auto end = steady_clock::now();
+	if (found == 0) {
+		std::cout << "(no bars found)" << endl;
+	}
+
+	return duration<double, nano>(end - start).count() / calls;
+}
+
+int main() {
+	constexpr Timeframe timeframe = Timeframe::MIN5;
+	constexpr size_t bar_count = 20;
+	constexpr size_t day = 24 * 60 * 60;
+
+	std::cout << "History (days) | bars | linear scan ns/call | binary search ns/call | cursor ns/call" << endl;
+	for (size_t days : { 1, 7, 30, 90, 180 }) {
+		Ticks ticks = generateTicks(days * day);
+		MarketDataManager market_data_manager(ticks);
+		BarsView view;
+
+		// build the bars before measuring
+		market_data_manager.getLastBarsBefore(timeframe, ticks.back().timestamp, 1, view);
+		Bars bars = calculateBars(timeframe, ticks);
+
+		// the linear scan is too slow for every tick of the long histories, so all the variants are sampled
+		size_t step = 97;
+		double linear = measure(ticks, step * days, [&](TimePoint time) {
+			return findLinearly(bars, time) >= (int)bar_count;
+			});
+		double binary = measure(ticks, step, [&](TimePoint time) {
+			return market_data_manager.getLastBarsBefore(timeframe, time, bar_count, view);
+			});
+		BarLookupCursor cursor;
+		double with_cursor = measure(ticks, step, [&](TimePoint time) {
+			return market_data_manager.getLastBarsBefore(timeframe, time, bar_count, view, &cursor);
+			});
+
+		std::cout << days << " | " << bars.size() << " | " << linear << " | " << binary << " | " << with_cursor << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+import AlgoTrading;
+import Backtesting;
+
+using namespace std;
+
+/**
+ * @brief Generates one tick per second with an oscillating price.
+ * @param count count of the ticks.
+ * @return generated ticks.
+ */
+Ticks generateTicks(size_t count) {
+	auto start = std::chrono::floor<std::chrono::hours>(std::chrono::system_clock::now());
+	Ticks ticks;
+	ticks.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		price bid = 1.0 + std::sin(i * 0.0001) * 0.01 + (i % 61) * 0.00001;
+		ticks.push_back({ start + std::chrono::seconds(i), bid, bid + 0.0002, 1, ChangeFlag::ASK_AND_BID });
+	}
+
+	return ticks;
+}
+
+/**
+ * @brief Minimums of the windows found by scanning the whole window for every bar, as the robot did before.
+ * @param values the values.
+ * @param period length of the window.
+ * @param results minimum of the window ending at every position.
+ */
+void scanMinimums(const vector<price>& values, size_t period, vector<price>& results) {
+	for (size_t i = period - 1; i < values.size(); ++i) {
+		results[i] = *std::min_element(values.begin() + (i + 1 - period), values.begin() + (i + 1));
+	}
+}
+
+/**
+ * @brief Measures the kernel and returns its duration per value in nanoseconds.
+ */
+template <typename Kernel>
+double measure(size_t count, Kernel kernel) {
+	using namespace std::chrono;
+
+	constexpr int repetitions = 5;
+	auto start = steady_clock::now();
+	for (int i = 0; i < repetitions; ++i) {
+		kernel();
+	}
+
+	auto end = steady_clock::now();
+	return duration<double, nano>(end - start).count() / repetitions / count;
+}
+
+/**
+ * @brief Largest absolute difference of the defined values of two series.
+ */
+price maxDifference(const vector<price>& a, const vector<price>& b, size_t from) {
+	price difference = 0;
+	for (size_t i = from; i < a.size(); ++i) {
+		difference = std::max(difference, std::abs(a[i] - b[i]));
+	}
+
+	return difference;
+}
+
+int main() {
+	constexpr size_t day = 24 * 60 * 60;
+	bool has_avx2 = getBestInstructionSet() == InstructionSet::AVX2;
+	if (!has_avx2) {
+		std::cout << "AVX2 is not supported, only the scalar kernels are measured." << endl;
+	}
+
+	Bars bars = calculateBars(Timeframe::MIN1, generateTicks(180 * day));
+	BarColumns columns(bars);
+	size_t count = columns.size();
+	InstructionSet vectorized = has_avx2 ? InstructionSet::AVX2 : InstructionSet::SCALAR;
+	std::cout << "MIN1 bars: " << count << endl;
+
+	std::cout << "Kernel | period | scalar ns/bar | AVX2 ns/bar | max abs diff" << endl;
+	vector<price> scalar(count);
+	vector<price> simd(count);
+	for (size_t period : { 20, 200 }) {
+		double scalar_ns = measure(count, [&]() { rollingSum(columns.closes, period, scalar, InstructionSet::SCALAR); });
+		double simd_ns = measure(count, [&]() { rollingSum(columns.closes, period, simd, vectorized); });
+		std::cout << "rolling sum | " << period << " | " << scalar_ns << " | " << simd_ns << " | "
+			<< maxDifference(scalar, simd, period - 1) << endl;
+
+		scalar_ns = measure(count, [&]() { rollingMinimum(columns.lows, period, scalar, InstructionSet::SCALAR); });
+		simd_ns = measure(count, [&]() { rollingMinimum(columns.lows, period, simd, vectorized); });
+		std::cout << "rolling minimum | " << period << " | " << scalar_ns << " | " << simd_ns << " | "
+			<< maxDifference(scalar, simd, period - 1) << endl;
+
+		double scan_ns = measure(count, [&]() { scanMinimums(columns.lows, period, scalar); });
+		std::cout << "window scan minimum | " << period << " | " << scan_ns << " | - | "
+			<< maxDifference(scalar, simd, period - 1) << endl;
+	}
+
+	double scalar_ns = measure(count, [&]() { trueRanges(columns, scalar, InstructionSet::SCALAR); });
+	double simd_ns = measure(count, [&]() { trueRanges(columns, simd, vectorized); });
+	std::cout << "true range | - | " << scalar_ns << " | " << simd_ns << " | " << maxDifference(scalar, simd, 0) << endl;
+
+	vector<size_t> periods = { 10, 20, 50, 100, 200, 500, 1000, 2000 };
+	vector<vector<price>> scalar_averages;
+	vector<vector<price>> simd_averages;
+	scalar_ns = measure(count * periods.size(), [&]() {
+		exponentialMovingAverages(columns.closes, periods, scalar_averages, InstructionSet::SCALAR);
+		});
+	simd_ns = measure(count * periods.size(), [&]() {
+		exponentialMovingAverages(columns.closes, periods, simd_averages, vectorized);
+		});
+	price difference = 0;
+	for (size_t k = 0; k < periods.size(); ++k) {
+		difference = std::max(difference, maxDifference(scalar_averages[k], simd_averages[k], periods[k] - 1));
+	}
+
+	std::cout << "EMA (" << periods.size() << " periods) | - | " << scalar_ns << " | " << simd_ns << " | " << difference << endl;
+	return 0;
+}
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <span>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+import AlgoTrading;
+import Backtesting;
+
+/**
+ * @brief Creates bars with the given close prices.
+ */
+Bars createBars(std::initializer_list<price> closes) {
+	auto start = std::chrono::floor<std::chrono::hours>(std::chrono::system_clock::now());
+	Bars bars;
+	for (price close : closes) {
+		TimePoint open_timestamp = start + std::chrono::minutes(bars.size());
+		bars.push_back({ open_timestamp, close, close + 0.5, close - 0.5, close, 1 });
+	}
+
+	return bars;
+}
+
+TEST(IndicatorsTest, SimpleMovingAverage) {
+	Bars bars = createBars({ 1, 2, 3, 4, 5, 6 });
+	auto values = calculateIndicator(Indicator::SMA, 3, bars);
+
+	ASSERT_EQ(values.size(), bars.size());
+	EXPECT_TRUE(std::isnan(values[0]));
+	EXPECT_TRUE(std::isnan(values[1]));
+	EXPECT_DOUBLE_EQ(values[2], 2);
+	EXPECT_DOUBLE_EQ(values[3], 3);
+	EXPECT_DOUBLE_EQ(values[5], 5);
+}
+
+TEST(IndicatorsTest, RelativeStrengthIndexOfRisingPrices) {
+	Bars bars = createBars({ 1, 2, 3, 4, 5, 6 });
+	auto values = calculateIndicator(Indicator::RSI, 3, bars);
+
+	EXPECT_TRUE(std::isnan(values[2]));
+	EXPECT_DOUBLE_EQ(values[3], 100);
+	EXPECT_DOUBLE_EQ(values[5], 100);
+}
+
+TEST(IndicatorsTest, BollingerBandsAreSymmetric) {
+	Bars bars = createBars({ 1, 3, 1, 3, 1, 3 });
+	auto upper = calculateIndicator(Indicator::BOLLINGER_UPPER, 2, bars);
+	auto lower = calculateIndicator(Indicator::BOLLINGER_LOWER, 2, bars);
+
+	EXPECT_DOUBLE_EQ(upper[1], 2 + BOLLINGER_DEVIATIONS);
+	EXPECT_DOUBLE_EQ(lower[1], 2 - BOLLINGER_DEVIATIONS);
+}
+
+TEST(IndicatorsTest, ExtendedSeriesMatchesWholeSeries) {
+	Bars bars = createBars({ 1, 4, 2, 5, 3, 6, 2, 7, 1, 8 });
+	for (Indicator indicator : { Indicator::SMA, Indicator::EMA, Indicator::ATR, Indicator::RSI, Indicator::BOLLINGER_UPPER, Indicator::LOWEST_LOW, Indicator::HIGHEST_HIGH }) {
+		auto expected = calculateIndicator(indicator, 3, bars);
+
+		IndicatorSeries series{ indicator, Timeframe::MIN1, 3 };
+		for (size_t count = 1; count <= bars.size(); ++count) {
+			extendIndicator(series, BarsView(bars).first(count));
+		}
+
+		for (size_t i = getFirstDefinedIndex(indicator, 3); i < bars.size(); ++i) {
+			// the whole series is summed by the kernels in a different order
+			EXPECT_NEAR(expected[i], series.values[i], 1e-12);
+		}
+	}
+}
+
+TEST(IndicatorsTest, CachedIndicatorIsShared) {
+	auto start = std::chrono::system_clock::now();
+	Ticks ticks;
+	for (size_t i = 0; i < 5000; i++)
+	{
+		price bid = 1.0 + (i % 29) * 0.001;
+		Tick tick{ start + std::chrono::seconds(10 * i), bid, bid + 0.0002, 1, ChangeFlag::ASK_AND_BID };
+		ticks.push_back(tick);
+	}
+
+	MarketDataManager market_data_manager(ticks);
+	IndicatorSeries* series = market_data_manager.getIndicator(Indicator::SMA, Timeframe::MIN5, 20);
+	EXPECT_EQ(series, market_data_manager.getIndicator(Indicator::SMA, Timeframe::MIN5, 20));
+	EXPECT_NE(series, market_data_manager.getIndicator(Indicator::SMA, Timeframe::MIN5, 21));
+
+	IndicatorValues values;
+	BarsView bars;
+	ASSERT_TRUE(market_data_manager.getLastIndicatorValuesAt(series, ticks.size() - 1, 3, values));
+	ASSERT_TRUE(market_data_manager.getLastBarsAt(Timeframe::MIN5, ticks.size() - 1, 20, bars));
+	price mean = 0;
+	for (const Bar& bar : bars) {
+		mean += bar.close;
+	}
+
+	EXPECT_NEAR(values.back(), mean / 20, 1e-12);
+}
+
+TEST(IndicatorsTest, PrecomputedAveragesMatchCachedAverages) {
+	auto start = std::chrono::system_clock::now();
+	Ticks ticks;
+	for (size_t i = 0; i < 20000; i++)
+	{
+		price bid = 1.0 + (i * 7919 % 29) * 0.001;
+		Tick tick{ start + std::chrono::seconds(10 * i), bid, bid + 0.0002, 1, ChangeFlag::ASK_AND_BID };
+		ticks.push_back(tick);
+	}
+
+	// the EMA series are calculated by the multi-period kernel, the other indicators one by one in parallel
+	MarketDataManager market_data_manager(ticks);
+	Bars bars = calculateBars(Timeframe::MIN5, ticks);
+	const size_t periods[] = { 9, 20, 5, 13, 34, 20, 50 };
+	for (Indicator indicator : { Indicator::EMA, Indicator::SMA }) {
+		IndicatorSeries* calculated_series = market_data_manager.getIndicator(indicator, Timeframe::MIN5, 13);
+		const price* calculated_values = calculated_series->values.data();
+		market_data_manager.precomputeIndicators(indicator, Timeframe::MIN5, periods);
+
+		// a series calculated before is kept
+		EXPECT_EQ(calculated_series->values.data(), calculated_values);
+
+		std::vector<const price*> precomputed_values;
+		for (size_t period : periods) {
+			IndicatorSeries* series = market_data_manager.getIndicator(indicator, Timeframe::MIN5, period);
+			auto expected = calculateIndicator(indicator, period, bars);
+			ASSERT_EQ(series->values.size(), expected.size());
+			for (size_t i = getFirstDefinedIndex(indicator, period); i < expected.size(); ++i) {
+				EXPECT_NEAR(series->values[i], expected[i], 1e-12);
+			}
+
+			precomputed_values.push_back(series->values.data());
+		}
+
+		// a period requested twice shares one series and precomputing again calculates nothing
+		EXPECT_EQ(precomputed_values[1], precomputed_values[5]);
+		market_data_manager.precomputeIndicators(indicator, Timeframe::MIN5, periods);
+		for (size_t k = 0; k < std::size(periods); ++k) {
+			EXPECT_EQ(market_data_manager.getIndicator(indicator, Timeframe::MIN5, periods[k])->values.data(), precomputed_values[k]);
+		}
+	}
+
+	EXPECT_THROW(market_data_manager.precomputeIndicators(Indicator::SMA, Timeframe::MIN5, std::vector<size_t>{ 3, 0 }), std::invalid_argument);
+}
+
+/**
+ * @brief Generates oscillating values with some noise.
+ */
+std::vector<price> generateValues(size_t count) {
+	std::vector<price> values;
+	for (size_t i = 0; i < count; ++i) {
+		values.push_back(1.0 + std::sin(i * 0.1) * 0.01 + (i * 7919 % 13) * 0.0001);
+	}
+
+	return values;
+}
+
+TEST(IndicatorKernelsTest, RollingExtremesMatchWindowScans) {
+	std::vector<price> values = generateValues(1003);
+	for (size_t period : { 1, 3, 4, 14, 200 }) {
+		std::vector<price> minimums(values.size());
+		std::vector<price> maximums(values.size());
+		rollingMinimum(values, period, minimums);
+		rollingMaximum(values, period, maximums);
+
+		EXPECT_TRUE(period == 1 || std::isnan(minimums[period - 2]));
+		for (size_t i = period - 1; i < values.size(); ++i) {
+			auto window = std::span(values).subspan(i + 1 - period, period);
+			EXPECT_EQ(minimums[i], *std::min_element(window.begin(), window.end()));
+			EXPECT_EQ(maximums[i], *std::max_element(window.begin(), window.end()));
+		}
+	}
+}
+
+TEST(IndicatorKernelsTest, VectorizedKernelsMatchScalarKernels) {
+	if (getBestInstructionSet() != InstructionSet::AVX2) {
+		GTEST_SKIP() << "AVX2 is not supported by the CPU.";
+	}
+
+	std::vector<price> values = generateValues(1001);
+	for (size_t period : { 1, 5, 20, 99 }) {
+		std::vector<price> scalar(values.size());
+		std::vector<price> vectorized(values.size());
+		rollingSum(values, period, scalar, InstructionSet::SCALAR);
+		rollingSum(values, period, vectorized, InstructionSet::AVX2);
+		for (size_t i = period - 1; i < values.size(); ++i) {
+			EXPECT_NEAR(scalar[i], vectorized[i], 1e-9);
+		}
+
+		rollingMaximum(values, period, scalar, InstructionSet::SCALAR);
+		rollingMaximum(values, period, vectorized, InstructionSet::AVX2);
+		EXPECT_TRUE(std::equal(scalar.begin() + period - 1, scalar.end(), vectorized.begin() + period - 1));
+	}
+
+	std::vector<size_t> periods = { 3, 10, 12, 26, 50, 100, 200 };
+	std::vector<std::vector<price>> scalar_averages;
+	std::vector<std::vector<price>> vectorized_averages;
+	exponentialMovingAverages(values, periods, scalar_averages, InstructionSet::SCALAR);
+	exponentialMovingAverages(values, periods, vectorized_averages, InstructionSet::AVX2);
+	for (size_t k = 0; k < periods.size(); ++k) {
+		for (size_t i = periods[k] - 1; i < values.size(); ++i) {
+			EXPECT_DOUBLE_EQ(scalar_averages[k][i], vectorized_averages[k][i]);
+		}
+	}
+
+	Bars bars = createBars({ 1, 4, 2, 5, 3, 6, 2, 7, 1, 8, 3 });
+	BarColumns columns(bars);
+	std::vector<price> scalar_ranges(bars.size());
+	std::vector<price> vectorized_ranges(bars.size());
+	trueRanges(columns, scalar_ranges, InstructionSet::SCALAR);
+	trueRanges(columns, vectorized_ranges, InstructionSet::AVX2);
+	EXPECT_EQ(scalar_ranges, vectorized_ranges);
+}
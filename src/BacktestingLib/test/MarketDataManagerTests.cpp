@@ -28,10 +28,23 @@ void printBar(const Bar& bar) {
 }
 
 
+void expectSameBars(BarsView expected, BarsView actual) {
+	ASSERT_EQ(expected.size(), actual.size());
+	for (size_t i = 0; i < expected.size(); i++) {
+		EXPECT_EQ(expected[i].open_timestamp, actual[i].open_timestamp);
+		EXPECT_EQ(expected[i].open, actual[i].open);
+		EXPECT_EQ(expected[i].high, actual[i].high);
+		EXPECT_EQ(expected[i].low, actual[i].low);
+		EXPECT_EQ(expected[i].close, actual[i].close);
+		EXPECT_EQ(expected[i].tick_volume, actual[i].tick_volume);
+	}
+}
+
 
 TEST_P(BarsCalculationTest2, CalculateBars) {
 	auto [timeframe, expectedCount] = GetParam();
-	auto now = std::chrono::system_clock::now();
+	// bars are aligned to the clock, so the ticks start at a full hour
+	auto now = std::chrono::floor<std::chrono::hours>(std::chrono::system_clock::now());
 	Ticks ticks;
 	for (size_t i = 0; i < 20; i++)
 	{
@@ -66,3 +79,171 @@ TEST_F(BarsCalculationTest, EmptyTicksReturnsEmptyBars) {
 }
 
 
+
+TEST(MarketDataManagerTest, IncrementalBarsMatchPrecomputedBars) {
+	auto start = std::chrono::system_clock::now();
+	Ticks ticks;
+	for (size_t i = 0; i < 2000; i++)
+	{
+		price bid = 1.0 + (i % 17) * 0.001;
+		Tick tick{ start + std::chrono::seconds(7 * i), bid, bid + 0.0002, 1, ChangeFlag::ASK_AND_BID };
+		ticks.push_back(tick);
+	}
+
+	MarketDataManager precomputed(ticks);
+	MarketDataManager incremental;
+	TicksViewSource tick_source(ticks, 100);
+	for (TicksView chunk = tick_source.next(); !chunk.empty(); chunk = tick_source.next()) {
+		for (const auto& tick : chunk) {
+			incremental.addTick(tick);
+		}
+	}
+
+	for (Timeframe timeframe : { Timeframe::MIN1, Timeframe::MIN5, Timeframe::MIN15, Timeframe::H1 }) {
+		BarsView expected;
+		BarsView actual;
+		ASSERT_TRUE(precomputed.getLastBarsBefore(timeframe, ticks.back().timestamp, 3, expected));
+		ASSERT_TRUE(incremental.getLastBarsBefore(timeframe, ticks.back().timestamp, 3, actual));
+		expectSameBars(expected, actual);
+	}
+}
+
+TEST_F(BarsCalculationTest, ColumnarBarsMatchTickBars) {
+	auto start = std::chrono::system_clock::now();
+	Ticks ticks;
+	for (size_t i = 0; i < 500; i++)
+	{
+		price bid = 1.0 + (i % 13) * 0.001;
+		Tick tick{ start + std::chrono::seconds(11 * i), bid, bid + 0.0003, i % 5, ChangeFlag::ASK_AND_BID };
+		ticks.push_back(tick);
+	}
+
+	TickColumns columns(ticks);
+	for (Timeframe timeframe : { Timeframe::MIN1, Timeframe::MIN5, Timeframe::H1 }) {
+		expectSameBars(calculateBars(timeframe, ticks), calculateBars(timeframe, columns));
+	}
+
+	// the manager over the columns builds its tick-to-bar index from the timestamp column
+	MarketDataManager tick_manager(ticks);
+	MarketDataManager column_manager(columns);
+	const Timeframe timeframes[] = { Timeframe::MIN5 };
+	column_manager.precomputeBars(timeframes);
+	for (size_t i = 0; i < ticks.size(); i += 7) {
+		BarsView expected;
+		BarsView actual;
+		bool is_found = tick_manager.getLastBarsAt(Timeframe::MIN5, i, 2, expected);
+		ASSERT_EQ(column_manager.getLastBarsAt(Timeframe::MIN5, i, 2, actual), is_found);
+		if (is_found) {
+			expectSameBars(expected, actual);
+		}
+	}
+}
+
+TEST(MarketDataManagerTest, CursorLookupsMatchSearchedLookups) {
+	auto start = std::chrono::system_clock::now();
+	Ticks ticks;
+	for (size_t i = 0; i < 3000; i++)
+	{
+		Tick tick{ start + std::chrono::seconds(5 * i), 1.0, 1.0002, 1, ChangeFlag::ASK_AND_BID };
+		ticks.push_back(tick);
+	}
+
+	MarketDataManager market_data_manager(ticks);
+	BarLookupCursor cursor;
+	for (size_t i = 1; i < ticks.size(); i += 7) {
+		BarsView expected;
+		BarsView actual;
+		bool found = market_data_manager.getLastBarsBefore(Timeframe::MIN5, ticks[i].timestamp, 2, expected);
+		ASSERT_EQ(found, market_data_manager.getLastBarsBefore(Timeframe::MIN5, ticks[i].timestamp, 2, actual, &cursor));
+		if (found) {
+			EXPECT_EQ(expected.data(), actual.data());
+		}
+	}
+}
+
+TEST(MarketDataManagerTest, IndexedLookupsMatchTimeLookups) {
+	auto start = std::chrono::system_clock::now();
+	Ticks ticks;
+	for (size_t i = 0; i < 3000; i++)
+	{
+		// pairs of ticks share a timestamp
+		Tick tick{ start + std::chrono::seconds(5 * (i / 2)), 1.0, 1.0002, 1, ChangeFlag::ASK_AND_BID };
+		ticks.push_back(tick);
+	}
+
+	MarketDataManager market_data_manager(ticks);
+	for (size_t i = 0; i < ticks.size(); i++) {
+		BarsView expected;
+		BarsView actual;
+		bool found = market_data_manager.getLastBarsBefore(Timeframe::MIN1, ticks[i].timestamp, 3, expected);
+		ASSERT_EQ(found, market_data_manager.getLastBarsAt(Timeframe::MIN1, i, 3, actual));
+		if (found) {
+			EXPECT_EQ(expected.data(), actual.data());
+		}
+	}
+}
+
+TEST_F(BarsCalculationTest, BarsAreAlignedToClock) {
+	using namespace std::chrono;
+
+	// Wednesday 13:17:03, the ticks continue after a gap of 37 hours 13 minutes
+	auto start = sys_days(year(2024) / 3 / 6) + 13h + 17min + 3s;
+	Ticks ticks;
+	for (size_t i = 0; i < 2000; i++)
+	{
+		TimePoint time = start + seconds(37 * i) + (i >= 1000 ? 37h + 13min : 0min);
+		price bid = 1.0 + (i % 11) * 0.001;
+		Tick tick{ time, bid, bid + 0.0002 * (i % 3), 1, ChangeFlag::ASK_AND_BID };
+		ticks.push_back(tick);
+	}
+
+	for (const Bar& bar : calculateBars(Timeframe::H1, ticks)) {
+		EXPECT_EQ(bar.open_timestamp.time_since_epoch() % 1h, 0h);
+	}
+
+	for (const Bar& bar : calculateBars(Timeframe::W1, ticks)) {
+		EXPECT_EQ(weekday(floor<days>(bar.open_timestamp)), Sunday);
+	}
+
+	// every level is aggregated from the level below, the result has to match H4 bars built directly from the ticks
+	Bars h4_from_ticks;
+	for (const Tick& tick : ticks) {
+		TimePoint open_time = tick.timestamp - tick.timestamp.time_since_epoch() % 4h;
+		if (h4_from_ticks.empty() || h4_from_ticks.back().open_timestamp != open_time) {
+			h4_from_ticks.emplace_back().openBar(tick);
+			h4_from_ticks.back().open_timestamp = open_time;
+		}
+		else {
+			h4_from_ticks.back().addTick(tick);
+		}
+	}
+
+	expectSameBars(h4_from_ticks, calculateBars(Timeframe::H4, ticks));
+}
+
+TEST(MarketDataManagerTest, PrecomputedBarsMatchLazilyCreatedBars) {
+	// the ticks are 350 ms off the minutes, so no tick opens a bar and the last tick is in the last bar
+	auto start = std::chrono::floor<std::chrono::hours>(std::chrono::system_clock::now()) + std::chrono::milliseconds(350);
+	Ticks ticks;
+	for (size_t i = 0; i < 290000; i++)
+	{
+		price bid = 1.0 + (i % 23) * 0.0001;
+		Tick tick{ start + std::chrono::milliseconds(700 * i), bid, bid + 0.0002, 1, ChangeFlag::ASK_AND_BID };
+		ticks.push_back(tick);
+	}
+
+	// the parallel MIN1 calculation merges bars cut by its ranges (here in the middle of minutes), so the whole series is compared
+	constexpr Timeframe timeframes[] = { Timeframe::MIN1, Timeframe::MIN15, Timeframe::D1 };
+	MarketDataManager lazy(ticks);
+	MarketDataManager eager(ticks);
+	eager.precomputeBars(timeframes);
+	for (Timeframe timeframe : timeframes) {
+		Bars expected = calculateBars(timeframe, ticks);
+		BarsView lazy_bars;
+		BarsView eager_bars;
+		ASSERT_TRUE(lazy.getLastBarsBefore(timeframe, ticks.back().timestamp, expected.size(), lazy_bars));
+		ASSERT_TRUE(eager.getLastBarsBefore(timeframe, ticks.back().timestamp, expected.size(), eager_bars));
+		expectSameBars(expected, lazy_bars);
+		expectSameBars(expected, eager_bars);
+	}
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+
+import AlgoTrading;
+import Backtesting;
+
+using namespace Backtesting;
+
+/**
+ * @brief Creates results of trading with trades of the given profits, every trade lasts one minute.
+ */
+TradingResults createResults(const std::vector<double>& profits) {
+	TradingResults results{};
+	results.summary.initial_balance = 1000;
+	TimePoint time = std::chrono::floor<std::chrono::hours>(std::chrono::system_clock::now());
+	for (double profit : profits) {
+		Trade trade{};
+		trade.open_time = time;
+		trade.close_time = time + std::chrono::minutes(1);
+		trade.open_price = 1;
+		trade.close_price = 1 + profit / 1000;
+		trade.volume = 1000;
+		trade.is_long = true;
+		results.trades.push_back(trade);
+		time = trade.close_time;
+	}
+
+	return results;
+}
+
+TEST(MonteCarloTest, ShuffleKeepsFinalBalance) {
+	MonteCarloAnalyzer analyzer(createResults({ 100, -50, 30, -80, 20, 60, -10 }));
+	MonteCarloSettings settings;
+	settings.path_count = 1000;
+	settings.method = ResamplingMethod::SHUFFLE;
+
+	ThreadPool thread_pool(2);
+	MonteCarloResults results = analyzer.run(thread_pool, settings);
+	EXPECT_EQ(results.path_count, 1000);
+	EXPECT_NEAR(results.final_balance.percentile_5, 1070, 1e-9);
+	EXPECT_NEAR(results.final_balance.percentile_95, 1070, 1e-9);
+
+	// the losses in a row are the worst order, no order avoids the largest loss
+	EXPECT_TRUE(results.max_drawdown.percentile_5 >= 80 - 1e-9);
+	EXPECT_TRUE(results.max_drawdown.percentile_95 <= 140 + 1e-9);
+	EXPECT_TRUE(results.max_drawdown.percentile_5 <= results.max_drawdown.median);
+	EXPECT_TRUE(results.longest_drawdown_duration.median >= 60);
+	EXPECT_EQ(results.ruin_probability, 0);
+}
+
+TEST(MonteCarloTest, BootstrapIsReproducible) {
+	MonteCarloAnalyzer analyzer(createResults({ 300, -400, 250, -350, 500, -600 }));
+	MonteCarloSettings settings;
+	settings.path_count = 2000;
+	settings.seed = 7;
+
+	ThreadPool one_worker(1);
+	ThreadPool three_workers(3);
+	MonteCarloResults results = analyzer.run(one_worker, settings);
+	MonteCarloResults again = analyzer.run(three_workers, settings);
+	EXPECT_EQ(results.final_balance.median, again.final_balance.median);
+	EXPECT_EQ(results.max_drawdown.percentile_95, again.max_drawdown.percentile_95);
+	EXPECT_EQ(results.ruin_probability, again.ruin_probability);
+
+	// drawing with replacement spreads the final balance and can ruin the account
+	EXPECT_LT(results.final_balance.percentile_5, results.final_balance.percentile_95);
+	EXPECT_GT(results.ruin_probability, 0);
+	EXPECT_LT(results.ruin_probability, 1);
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <limits>
+
+import Backtesting;
+
+using namespace Backtesting;
+
+/**
+ * @brief Creates summary of trading with the given final balance and drawdown.
+ */
+TradingSummary createSummary(double account_balance, double max_drawdown) {
+	TradingSummary summary;
+	summary.initial_balance = 1000;
+	summary.account_balance = account_balance;
+	summary.max_drawdown = max_drawdown;
+	return summary;
+}
+
+TEST(ObjectivesTest, SummaryRatios) {
+	TradingSummary summary = createSummary(1100, 50);
+	summary.trade_count = 4;
+	summary.winning_trade_count = 3;
+	summary.gross_profit = 150;
+	summary.gross_loss = 50;
+	// returns 0.1, 0.1, 0.1, -0.1
+	summary.sum_of_returns = 0.2;
+	summary.sum_of_squared_returns = 0.04;
+
+	EXPECT_DOUBLE_EQ(summary.getWinRate(), 0.75);
+	EXPECT_DOUBLE_EQ(summary.getReturn(), 0.1);
+	EXPECT_DOUBLE_EQ(profitFactor(summary), 3);
+	EXPECT_DOUBLE_EQ(returnToDrawdown(summary), 2);
+	EXPECT_DOUBLE_EQ(lowMaxDrawdown(summary), -50);
+	EXPECT_DOUBLE_EQ(sharpeRatio(summary), 0.5);
+}
+
+TEST(ObjectivesTest, TopKKeepsBestSummaries) {
+	std::vector<double> balances = { 900, 1200, 1100, 1200, 1000, 1300 };
+	TopK first(3);
+	TopK second(3);
+	for (size_t i = 0; i < balances.size(); ++i) {
+		TradingSummary summary = createSummary(balances[i], 0);
+		(i % 2 == 0 ? first : second).add(ScoredSummary{ score(finalBalance, summary), i, summary });
+	}
+
+	first.merge(second);
+	std::vector<ScoredSummary> top = first.getSorted();
+	ASSERT_EQ(top.size(), 3);
+	EXPECT_EQ(top[0].combination_index, 5);
+	// ties are resolved in favor of the earlier combination
+	EXPECT_EQ(top[1].combination_index, 1);
+	EXPECT_EQ(top[2].combination_index, 3);
+}
+
+TEST(ObjectivesTest, ParetoFrontKeepsNonDominatedSummaries) {
+	const ObjectivePtr objectives[] = { finalBalance, lowMaxDrawdown };
+	ParetoFront front(objectives, 10);
+	front.add(0, createSummary(1100, 100));
+	front.add(1, createSummary(1200, 300));
+	front.add(2, createSummary(1000, 200)); // dominated by 0
+	front.add(3, createSummary(1050, 50));
+	front.add(4, createSummary(1100, 100)); // equal to 0
+
+	std::vector<ParetoPoint> points = front.getSorted();
+	ASSERT_EQ(points.size(), 3);
+	EXPECT_EQ(points[0].combination_index, 1);
+	EXPECT_EQ(points[1].combination_index, 0);
+	EXPECT_EQ(points[2].combination_index, 3);
+
+	ParetoFront bounded(objectives, 2);
+	for (size_t i = 0; i < points.size(); ++i) {
+		bounded.add(points[i]);
+	}
+
+	// the worst point in the first objective is dropped
+	EXPECT_EQ(bounded.getSorted().back().combination_index, 0);
+}
+
+TEST(ObjectivesTest, SharedScoreBoundIsKthBestScore) {
+	SharedScoreBound bound(2);
+	bound.add(5);
+	EXPECT_EQ(bound.get(), -std::numeric_limits<double>::infinity());
+	bound.add(3);
+	EXPECT_EQ(bound.get(), 3);
+	bound.add(4);
+	EXPECT_EQ(bound.get(), 4);
+	bound.add(1);
+	EXPECT_EQ(bound.get(), 4);
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+
+import Backtesting;
+
+using namespace Backtesting;
+
+TEST(ParameterSpaceTest, SobolFillsDyadicIntervals) {
+	for (uint64_t seed : { 0, 42 }) {
+		SobolSequence sequence(SobolSequence::MAX_DIMENSION_COUNT, seed);
+		constexpr size_t count = 256;
+		std::vector<std::vector<int>> hits(SobolSequence::MAX_DIMENSION_COUNT, std::vector<int>(count));
+		std::vector<double> point(SobolSequence::MAX_DIMENSION_COUNT);
+		for (size_t i = 0; i < count; ++i) {
+			sequence.next(point);
+			for (size_t dimension = 0; dimension < point.size(); ++dimension) {
+				ASSERT_TRUE(point[dimension] >= 0 && point[dimension] < 1);
+				hits[dimension][static_cast<size_t>(point[dimension] * count)]++;
+			}
+		}
+
+		// every interval of every dimension holds exactly one of the first 2^k points
+		for (const std::vector<int>& dimension_hits : hits) {
+			for (int interval_hits : dimension_hits) {
+				EXPECT_EQ(interval_hits, 1);
+			}
+		}
+	}
+
+	EXPECT_THROW(SobolSequence(SobolSequence::MAX_DIMENSION_COUNT + 1), std::invalid_argument);
+}
+
+TEST(ParameterSpaceTest, ValuesAreSnappedToSteps) {
+	ParameterSpace parameter_space({ { 5, 11, 1 }, { 0.005, 0.02, 0.005 }, { 1, 2 } });
+	ASSERT_EQ(parameter_space.getDimensionCount(), 3);
+
+	std::vector<double> lowest = parameter_space.getValues(std::vector<double>{ 0, 0, 0 });
+	EXPECT_EQ(lowest, std::vector<double>({ 5, 0.005, 1 }));
+
+	std::vector<double> highest = parameter_space.getValues(std::vector<double>{ 0.999, 0.999, 1 });
+	EXPECT_EQ(highest[0], 11);
+	EXPECT_NEAR(highest[1], 0.02, 1e-12);
+	EXPECT_EQ(highest[2], 2);
+
+	std::vector<double> middle = parameter_space.getValues(std::vector<double>{ 0.5, 0.5, 0.25 });
+	EXPECT_EQ(middle[0], 8);
+	EXPECT_NEAR(middle[1], 0.015, 1e-12);
+	EXPECT_EQ(middle[2], 1.25);
+
+	EXPECT_THROW(ParameterSpace({ { 2, 1, 1 } }), std::invalid_argument);
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+
+import AlgoTrading;
+import Backtesting;
+
+using namespace Backtesting;
+
+/**
+ * @brief Generates ticks oscillating around the given price level.
+ */
+Ticks createTicks(TimePoint start, size_t count, std::chrono::milliseconds step, price level) {
+	Ticks ticks;
+	for (size_t i = 0; i < count; i++)
+	{
+		price bid = level * (1.0 + (i * 7919 % 101) * 0.0001);
+		Tick tick{ start + step * i, bid, bid + level * 0.0002, 1, ChangeFlag::ASK_AND_BID };
+		ticks.push_back(tick);
+	}
+
+	return ticks;
+}
+
+/**
+ * @brief Robot trading breakouts of the last closed bar of the symbol of every tick.
+ */
+class SymbolBreakoutRobot : public ATS {
+public:
+	explicit SymbolBreakoutRobot(double relative_range) : _relative_range(relative_range) {}
+
+	ReturnCode start(BrokerConnection* broker_connection) override {
+		_broker = broker_connection;
+		_last_bar_timestamps.resize(broker_connection->getSymbolCount());
+		return OK;
+	}
+
+	int onTick(const Tick& tick) override {
+		size_t symbol = _broker->getCurrentSymbol();
+		BarsView bars;
+		if (!_broker->getLastBars(Timeframe::MIN1, 2, bars) || bars[1].open_timestamp == _last_bar_timestamps[symbol]) {
+			return OK;
+		}
+
+		_last_bar_timestamps[symbol] = bars[1].open_timestamp;
+
+		price range = tick.bid * _relative_range;
+		Order order;
+		order.volume = 1000;
+		order.symbol = symbol;
+		order.is_long = tick.bid > bars[0].close;
+		order.stoploss = order.is_long ? tick.bid - range : tick.ask + range;
+		order.takeprofit = order.is_long ? tick.bid + range : tick.ask - range;
+		Position::Id id;
+		_broker->tryCreatePosition(order, id);
+
+		// the bars of the other symbols are available from their last ticks
+		for (size_t other = 0; other < _broker->getSymbolCount(); ++other) {
+			other_bars_found += _broker->getLastSymbolBars(other, Timeframe::MIN1, 1, bars) ? 1 : 0;
+		}
+
+		return OK;
+	}
+
+	void end() override {
+		_broker->closeAllPositions();
+	}
+
+	size_t other_bars_found = 0;
+
+private:
+	BrokerConnection* _broker = nullptr;
+	double _relative_range;
+	std::vector<TimePoint> _last_bar_timestamps;
+};
+
+TEST(PortfolioTesterTest, TickMergerMergesInTimeOrder) {
+	auto start = std::chrono::floor<std::chrono::hours>(std::chrono::system_clock::now());
+	Ticks a = createTicks(start, 100, std::chrono::milliseconds(300), 1.0);
+	Ticks b = createTicks(start, 70, std::chrono::milliseconds(500), 1.0);
+	Ticks c;
+	std::vector<TicksView> ticks_by_symbol{ a, b, c };
+
+	TickMerger merger(ticks_by_symbol);
+	size_t symbol;
+	size_t tick_index;
+	size_t count = 0;
+	TimePoint last_timestamp = start;
+	size_t last_symbol = 0;
+	while (merger.next(symbol, tick_index)) {
+		TimePoint timestamp = ticks_by_symbol[symbol][tick_index].timestamp;
+		ASSERT_FALSE(timestamp < last_timestamp);
+		if (timestamp == last_timestamp && count > 0) {
+			EXPECT_LT(last_symbol, symbol);
+		}
+
+		last_timestamp = timestamp;
+		last_symbol = symbol;
+		++count;
+	}
+
+	EXPECT_EQ(count, a.size() + b.size());
+	EXPECT_FALSE(merger.next(symbol, tick_index));
+}
+
+TEST(PortfolioTesterTest, SingleSymbolMatchesStrategyTester) {
+	auto start = std::chrono::floor<std::chrono::hours>(std::chrono::system_clock::now());
+	Ticks ticks = createTicks(start, 20000, std::chrono::milliseconds(700), 1.0);
+
+	for (SimulationPeriod period : { SimulationPeriod::TICK, SimulationPeriod::S5 }) {
+		StrategyTester tester(&ticks, period, AccountProperties());
+		PortfolioTester portfolio_tester({ TicksView(ticks) }, period, AccountProperties());
+
+		SymbolBreakoutRobot robot(0.002);
+		TradingResults expected = tester.run(robot);
+		SymbolBreakoutRobot portfolio_robot(0.002);
+		TradingResults results = portfolio_tester.run(portfolio_robot);
+
+		ASSERT_FALSE(expected.trades.empty());
+		EXPECT_EQ(expected.account_balance, results.account_balance);
+		EXPECT_EQ(expected.total_equity, results.total_equity);
+		ASSERT_EQ(expected.trades.size(), results.trades.size());
+		for (size_t i = 0; i < expected.trades.size(); ++i) {
+			EXPECT_EQ(expected.trades[i].close_time, results.trades[i].close_time);
+			EXPECT_EQ(expected.trades[i].close_price, results.trades[i].close_price);
+		}
+	}
+}
+
+TEST(PortfolioTesterTest, SymbolsShareOneAccount) {
+	auto start = std::chrono::floor<std::chrono::hours>(std::chrono::system_clock::now());
+	Ticks cheap = createTicks(start, 20000, std::chrono::milliseconds(700), 1.0);
+	Ticks expensive = createTicks(start + std::chrono::milliseconds(350), 10000, std::chrono::milliseconds(1400), 100.0);
+
+	AccountProperties properties;
+	properties.account_balance = 1000000;
+	PortfolioTester tester({ TicksView(cheap), TicksView(expensive) }, SimulationPeriod::TICK, std::move(properties));
+	EXPECT_EQ(tester.getSymbolCount(), 2);
+
+	SymbolBreakoutRobot robot(0.002);
+	TradingResults results = tester.run(robot);
+
+	double profit = 0;
+	size_t trade_counts[2]{};
+	for (const Trade& trade : results.trades) {
+		ASSERT_LT(trade.symbol, 2);
+		++trade_counts[trade.symbol];
+		profit += trade.calculateProfit();
+
+		// the prices of the trade are the prices of its symbol
+		double level = trade.symbol == 0 ? 1.0 : 100.0;
+		EXPECT_GT(trade.close_price, level * 0.9);
+		EXPECT_LT(trade.close_price, level * 1.1);
+	}
+
+	EXPECT_GT(trade_counts[0], 0);
+	EXPECT_GT(trade_counts[1], 0);
+	EXPECT_NEAR(results.account_balance, 1000000 + profit, 1e-6);
+	EXPECT_GT(robot.other_bars_found, 0);
+}
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <numeric>
+#include <atomic>
+#include <span>
+#include <random>
+#include <algorithm>
+#include "StrategyTestUtils.h"
+
+import AlgoTrading;
+import Backtesting;
+
+using namespace Backtesting;
+
+BreakoutParameters mutateBreakoutParameters(const BreakoutParameters& params, std::mt19937_64& random_generator) {
+	std::uniform_int_distribution<int> step(-3, 3);
+	return BreakoutParameters(std::clamp(params.range + 0.0005 * step(random_generator), 0.0005, 0.01), params.tick_limit);
+}
+
+BreakoutParameters crossBreakoutParameters(const BreakoutParameters& a, const BreakoutParameters& b, std::mt19937_64&) {
+	return BreakoutParameters((a.range + b.range) / 2, a.tick_limit);
+}
+
+size_t created_parameter_count = 0;
+
+BreakoutParameters createBreakoutParameters(std::span<const double> values) {
+	++created_parameter_count;
+	return BreakoutParameters(values[0], 20000);
+}
+
+std::atomic<size_t> simulated_tick_count = 0;
+
+/**
+ * @brief Robot counting the ticks simulated by all its instances.
+ */
+class TickCountingRobot : public ATS {
+public:
+	int onTick(const Tick&) override {
+		++simulated_tick_count;
+		return OK;
+	}
+
+	void end() override {}
+};
+
+TickCountingRobot createTickCountingRobot(size_t) {
+	return TickCountingRobot();
+}
+
+TEST(StrategyOptimizerTest, EvolutionIsReproducible) {
+	Ticks ticks = createTicks();
+
+	StrategyTester tester(&ticks, SimulationPeriod::TICK, AccountProperties());
+	StrategyOptimizer<BreakoutRobot, BreakoutParameters> optimizer(&tester, createBreakoutRobot);
+	std::vector<BreakoutParameters> initial_population = createBreakoutCombinations(4, ticks.size(), 0.001);
+
+	EvolutionSettings settings;
+	settings.population_size = 6;
+	settings.generation_count = 5;
+	settings.max_evaluations = 20;
+	settings.seed = 42;
+
+	ThreadPool one_worker(1);
+	ThreadPool two_workers(2);
+	auto evolved = optimizer.findBestParametersEvolved(
+		one_worker, initial_population, mutateBreakoutParameters, crossBreakoutParameters, finalBalance, settings);
+	auto evolved_again = optimizer.findBestParametersEvolved(
+		two_workers, initial_population, mutateBreakoutParameters, crossBreakoutParameters, finalBalance, settings);
+	EXPECT_EQ(evolved.second.range, evolved_again.second.range);
+	EXPECT_EQ(evolved.first.account_balance, evolved_again.first.account_balance);
+
+	// the initial population is evaluated first and the best one is always kept
+	auto best_initial = optimizer.findBestParameters(one_worker, initial_population);
+	EXPECT_TRUE(evolved.first.account_balance >= best_initial.first.account_balance);
+}
+
+TEST(StrategyOptimizerTest, SuccessiveHalvingKeepsWinnersOfPrefixes) {
+	Ticks ticks = createTicks();
+
+	StrategyTester tester(&ticks, SimulationPeriod::TICK, AccountProperties());
+	StrategyOptimizer<BreakoutRobot, BreakoutParameters> optimizer(&tester, createBreakoutRobot);
+	std::vector<BreakoutParameters> combinations = createBreakoutCombinations(16, ticks.size());
+
+	ThreadPool thread_pool(2);
+	auto grid_best = optimizer.findBestParameters(thread_pool, combinations);
+	auto single_round = optimizer.findBestParametersHalving(thread_pool, combinations, finalBalance, 1);
+	EXPECT_EQ(single_round.second.range, grid_best.second.range);
+	EXPECT_EQ(single_round.first.account_balance, grid_best.first.account_balance);
+
+	auto halving = optimizer.findBestParametersHalving(thread_pool, combinations);
+	BreakoutRobot robot(halving.second.range, ticks.size());
+	EXPECT_EQ(halving.first.account_balance, tester.run(robot).account_balance);
+	EXPECT_TRUE(grid_best.first.account_balance >= halving.first.account_balance);
+}
+
+TEST(StrategyOptimizerTest, SuccessiveHalvingSimulatesATenthOfTheGrid) {
+	Ticks ticks = createTicks();
+
+	StrategyTester tester(&ticks, SimulationPeriod::TICK, AccountProperties());
+	StrategyOptimizer<TickCountingRobot, size_t> optimizer(&tester, createTickCountingRobot);
+	std::vector<size_t> combinations(64);
+	std::iota(combinations.begin(), combinations.end(), 0);
+
+	// the grid search simulates every combination on all the ticks
+	ThreadPool thread_pool(2);
+	simulated_tick_count = 0;
+	optimizer.findBestParametersHalving(thread_pool, combinations);
+	EXPECT_LE(simulated_tick_count * 10, combinations.size() * ticks.size());
+}
+
+TEST(StrategyOptimizerTest, SampledSearchTestsEveryValueOnce) {
+	Ticks ticks = createTicks();
+
+	StrategyTester tester(&ticks, SimulationPeriod::TICK, AccountProperties());
+	StrategyOptimizer<BreakoutRobot, BreakoutParameters> optimizer(&tester, createBreakoutRobot);
+	std::vector<BreakoutParameters> combinations = createBreakoutCombinations(16, ticks.size());
+
+	ThreadPool thread_pool(2);
+	auto grid_best = optimizer.findBestParameters(thread_pool, combinations);
+
+	// the initial sample already covers all the 16 values, the refinement finds nothing new
+	ParameterSpace parameter_space({ { 0.0005, 0.008, 0.0005 } });
+	SamplingSettings settings;
+	settings.max_evaluations = 32;
+	created_parameter_count = 0;
+	auto sampled = optimizer.findBestParametersSampled(thread_pool, parameter_space, createBreakoutParameters, finalBalance, settings);
+	EXPECT_EQ(created_parameter_count, 16);
+	EXPECT_EQ(sampled.first.account_balance, grid_best.first.account_balance);
+
+	settings.max_evaluations = 6;
+	created_parameter_count = 0;
+	optimizer.findBestParametersSampled(thread_pool, parameter_space, createBreakoutParameters, finalBalance, settings);
+	EXPECT_EQ(created_parameter_count, 6);
+}
+
+TEST(StrategyOptimizerTest, WalkForwardStitchesOutOfSampleWindows) {
+	Ticks ticks = createTicks();
+
+	StrategyTester tester(&ticks, SimulationPeriod::TICK, AccountProperties());
+	StrategyOptimizer<BreakoutRobot, BreakoutParameters> optimizer(&tester, createBreakoutRobot);
+	std::vector<BreakoutParameters> combinations = createBreakoutCombinations(8, ticks.size());
+
+	ThreadPool thread_pool(2);
+	auto results = optimizer.walkForward(thread_pool, combinations, WalkForwardSettings(8000, 4000));
+	ASSERT_EQ(results.windows.size(), 3);
+
+	size_t trade_count = 0;
+	double balance = AccountProperties().account_balance;
+	for (const auto& window : results.windows) {
+		// the winner of every window is the best combination of its in-sample ticks
+		ScoredSummary best;
+		for (size_t i = 0; i < combinations.size(); ++i) {
+			BreakoutRobot robot = createBreakoutRobot(combinations[i]);
+			TradingSummary summary = tester.runSummary(robot, window.in_sample_begin, window.out_of_sample_begin);
+			ScoredSummary scored{ finalBalance(summary), i, summary };
+			best = isBetter(scored, best) ? scored : best;
+		}
+
+		EXPECT_EQ(window.in_sample.combination_index, best.combination_index);
+		EXPECT_EQ(window.out_of_sample_begin - window.in_sample_begin, 8000);
+		EXPECT_EQ(window.out_of_sample_end - window.out_of_sample_begin, 4000);
+
+		BreakoutRobot robot = createBreakoutRobot(window.parameters);
+		TradingResults out_of_sample = tester.run(robot, window.out_of_sample_begin, window.out_of_sample_end);
+		EXPECT_EQ(window.out_of_sample.account_balance, out_of_sample.account_balance);
+		trade_count += out_of_sample.trades.size();
+		balance += out_of_sample.account_balance - AccountProperties().account_balance;
+	}
+
+	EXPECT_EQ(results.summary.trade_count, trade_count);
+	EXPECT_EQ(results.equity.size(), trade_count + 1);
+	EXPECT_NEAR(results.summary.account_balance, balance, 1e-6);
+	EXPECT_NEAR(results.equity.back(), balance, 1e-6);
+}
+
+TEST(StrategyOptimizerTest, PrunedRunsAreNotRanked) {
+	Ticks ticks = createTicks();
+
+	StrategyTester tester(&ticks, SimulationPeriod::TICK, AccountProperties());
+	StrategyOptimizer<BreakoutRobot, BreakoutParameters> optimizer(&tester, createBreakoutRobot);
+	std::vector<BreakoutParameters> combinations = createBreakoutCombinations(8, ticks.size(), 0.001);
+	std::vector<double> drawdowns;
+	for (const BreakoutParameters& parameters : combinations) {
+		BreakoutRobot robot = createBreakoutRobot(parameters);
+		drawdowns.push_back(tester.runSummary(robot).max_drawdown);
+	}
+
+	// the drawdown can only grow, so exactly the runs ending within the limit finish
+	std::vector<double> sorted_drawdowns = drawdowns;
+	std::sort(sorted_drawdowns.begin(), sorted_drawdowns.end());
+	ThreadPool thread_pool(2);
+	AbortRules abort_rules;
+	abort_rules.max_drawdown = sorted_drawdowns[drawdowns.size() / 2];
+	size_t finished_count = std::count_if(drawdowns.begin(), drawdowns.end(), [&](double drawdown) { return drawdown <= abort_rules.max_drawdown; });
+	ASSERT_LT(finished_count, combinations.size());
+	std::vector<ScoredSummary> top = optimizer.findTopParameters(thread_pool, combinations, combinations.size(), finalBalance, nullptr, abort_rules);
+	ASSERT_EQ(top.size(), finished_count);
+	for (const ScoredSummary& scored : top) {
+		EXPECT_FALSE(scored.summary.is_pruned);
+		EXPECT_LE(drawdowns[scored.combination_index], abort_rules.max_drawdown);
+	}
+
+	// nothing is returned when every run is pruned
+	abort_rules.max_drawdown = sorted_drawdowns.front() / 2;
+	EXPECT_TRUE(optimizer.findTopParameters(thread_pool, combinations, 1, finalBalance, nullptr, abort_rules).empty());
+	auto best = optimizer.findBestParameters(thread_pool, combinations, nullptr, finalBalance, abort_rules);
+	EXPECT_EQ(best.first.account_balance, 0);
+	EXPECT_TRUE(best.first.trades.empty());
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+
+import AlgoTrading;
+import Backtesting;
+
+/**
+ * @brief Generates ticks oscillating around 1.0, one tick per 700 ms from the start of the current hour.
+ */
+inline Ticks createTicks(size_t count = 20000) {
+	auto start = std::chrono::floor<std::chrono::hours>(std::chrono::system_clock::now());
+	Ticks ticks;
+	for (size_t i = 0; i < count; i++)
+	{
+		price bid = 1.0 + (i * 7919 % 101) * 0.0001;
+		Tick tick{ start + std::chrono::milliseconds(700 * i), bid, bid + 0.0002, 1, ChangeFlag::ASK_AND_BID };
+		ticks.push_back(tick);
+	}
+
+	return ticks;
+}
+
+/**
+ * @brief Robot trading breakouts of the last closed bar, stops after the given count of ticks.
+ */
+class BreakoutRobot : public ATS {
+public:
+	BreakoutRobot(price range, size_t tick_limit) : _range(range), _tick_limit(tick_limit) {}
+
+	ReturnCode start(BrokerConnection* broker_connection) override {
+		_broker = broker_connection;
+		return _tick_limit == 0 ? STOP : OK;
+	}
+
+	int onTick(const Tick& tick) override {
+		if (++_tick_count >= _tick_limit) {
+			return STOP;
+		}
+
+		BarsView bars;
+		if (!_broker->getLastBars(Timeframe::MIN1, 2, bars) || bars[1].open_timestamp == _last_bar_timestamp) {
+			return OK;
+		}
+
+		_last_bar_timestamp = bars[1].open_timestamp;
+
+		Order order;
+		order.volume = 1000;
+		order.is_long = tick.bid > bars[0].close;
+		order.stoploss = order.is_long ? tick.bid - _range : tick.ask + _range;
+		order.takeprofit = order.is_long ? tick.bid + _range : tick.ask - _range;
+		Position::Id id;
+		_broker->tryCreatePosition(order, id);
+		return OK;
+	}
+
+	void end() override {
+		_broker->closeAllPositions();
+	}
+
+private:
+	BrokerConnection* _broker = nullptr;
+	price _range;
+	size_t _tick_limit;
+	size_t _tick_count = 0;
+	TimePoint _last_bar_timestamp;
+};
+
+/**
+ * @brief Parameters of the BreakoutRobot tested by the optimizer.
+ */
+struct BreakoutParameters {
+	price range;
+	size_t tick_limit;
+};
+
+inline BreakoutRobot createBreakoutRobot(BreakoutParameters params) {
+	return BreakoutRobot(params.range, params.tick_limit);
+}
+
+/**
+ * @brief Creates combinations of BreakoutParameters with the ranges range_step, 2 * range_step, ...
+ */
+inline std::vector<BreakoutParameters> createBreakoutCombinations(size_t count, size_t tick_limit, price range_step = 0.0005) {
+	std::vector<BreakoutParameters> combinations;
+	for (size_t i = 0; i < count; ++i) {
+		combinations.emplace_back(range_step * (i + 1), tick_limit);
+	}
+
+	return combinations;
+}
+
+/**
+ * @brief Expects both results to end with the same balance and equity after the same trades.
+ */
+inline void expectSameTrades(const Backtesting::TradingResults& expected, const Backtesting::TradingResults& actual) {
+	EXPECT_EQ(expected.account_balance, actual.account_balance);
+	EXPECT_EQ(expected.total_equity, actual.total_equity);
+	ASSERT_EQ(expected.trades.size(), actual.trades.size());
+	for (size_t i = 0; i < expected.trades.size(); ++i) {
+		EXPECT_EQ(expected.trades[i].open_time, actual.trades[i].open_time);
+		EXPECT_EQ(expected.trades[i].close_time, actual.trades[i].close_time);
+		EXPECT_EQ(expected.trades[i].open_price, actual.trades[i].open_price);
+		EXPECT_EQ(expected.trades[i].close_price, actual.trades[i].close_price);
+	}
+}
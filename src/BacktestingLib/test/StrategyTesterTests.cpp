@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+#include "StrategyTestUtils.h"
+
+import AlgoTrading;
+import Backtesting;
+
+using namespace Backtesting;
+
+TEST(StrategyTesterTest, BatchedRunMatchesSequentialRuns) {
+	Ticks ticks = createTicks();
+
+	for (SimulationPeriod period : { SimulationPeriod::TICK, SimulationPeriod::S5 }) {
+		StrategyTester tester(&ticks, period, AccountProperties());
+
+		// the tick limits make some robots stop at the start and inside and at the end of a tick chunk
+		std::vector<BreakoutRobot> sequential_robots;
+		std::vector<BreakoutRobot> batched_robots;
+		for (size_t i = 0; i < 7; ++i) {
+			price range = 0.001 * (i + 1);
+			size_t tick_limit = i == 0 ? 0 : i * 3000 + 1024;
+			sequential_robots.emplace_back(range, tick_limit);
+			batched_robots.emplace_back(range, tick_limit);
+		}
+
+		std::vector<ATS*> robot_ptrs;
+		for (BreakoutRobot& robot : batched_robots) {
+			robot_ptrs.push_back(&robot);
+		}
+
+		std::vector<TradingResults> batched_results = tester.runBatch(robot_ptrs);
+		ASSERT_EQ(batched_results.size(), sequential_robots.size());
+		for (size_t i = 0; i < sequential_robots.size(); ++i) {
+			expectSameTrades(tester.run(sequential_robots[i]), batched_results[i]);
+		}
+	}
+}
+
+TEST(StrategyTesterTest, TickSourceRunMatchesRun) {
+	Ticks ticks = createTicks();
+
+	for (SimulationPeriod period : { SimulationPeriod::TICK, SimulationPeriod::S5 }) {
+		StrategyTester tester(&ticks, period, AccountProperties());
+		BreakoutRobot robot(0.002, ticks.size());
+		TradingResults expected = tester.run(robot);
+
+		// the chunk size does not divide the count of the ticks, so the last chunk is partial
+		StrategyTester source_tester(period, AccountProperties());
+		TicksViewSource tick_source(ticks, 777);
+		BreakoutRobot source_robot(0.002, ticks.size());
+		TradingResults results = source_tester.run(source_robot, tick_source);
+
+		ASSERT_FALSE(expected.trades.empty());
+		expectSameTrades(expected, results);
+	}
+}
+
+TEST(StrategyTesterTest, SummaryMatchesResults) {
+	Ticks ticks = createTicks();
+
+	StrategyTester tester(&ticks, SimulationPeriod::TICK, AccountProperties());
+	BreakoutRobot robot(0.002, ticks.size());
+	TradingResults results = tester.run(robot);
+	BreakoutRobot summarized_robot(0.002, ticks.size());
+	TradingSummary summary = tester.runSummary(summarized_robot);
+
+	size_t winning_trade_count = 0;
+	for (const Trade& trade : results.trades) {
+		winning_trade_count += trade.calculateProfit() > 0 ? 1 : 0;
+	}
+
+	ASSERT_FALSE(results.trades.empty());
+	EXPECT_EQ(summary.account_balance, results.account_balance);
+	EXPECT_EQ(summary.total_equity, results.total_equity);
+	EXPECT_EQ(summary.trade_count, results.trades.size());
+	EXPECT_EQ(summary.winning_trade_count, winning_trade_count);
+	EXPECT_GT(summary.max_drawdown, 0);
+}
+
+TEST(StrategyTesterTest, AbortRulesPruneRuns) {
+	Ticks ticks = createTicks();
+
+	StrategyTester tester(&ticks, SimulationPeriod::TICK, AccountProperties());
+	BreakoutRobot robot(0.002, ticks.size());
+	TradingSummary full = tester.runSummary(robot);
+	EXPECT_FALSE(full.is_pruned);
+
+	AbortRules drawdown_rules;
+	drawdown_rules.max_drawdown = full.max_drawdown / 2;
+	BreakoutRobot drawdown_robot(0.002, ticks.size());
+	TradingSummary pruned = tester.runSummary(drawdown_robot, drawdown_rules);
+	EXPECT_TRUE(pruned.is_pruned);
+	EXPECT_LT(pruned.trade_count, full.trade_count);
+
+	AbortRules trade_rules;
+	trade_rules.min_trade_count = full.trade_count;
+	trade_rules.min_trades_deadline = ticks[ticks.size() / 2].timestamp;
+	BreakoutRobot trade_robot(0.002, ticks.size());
+	EXPECT_TRUE(tester.runSummary(trade_robot, trade_rules).is_pruned);
+
+	// the drawdown can only grow, so a bound above the final score aborts the run
+	SharedScoreBound bound(1);
+	bound.add(lowMaxDrawdown(full) + 1);
+	AbortRules bound_rules;
+	bound_rules.optimistic_score = lowMaxDrawdown;
+	bound_rules.score_bound = &bound;
+	BreakoutRobot bound_robot(0.002, ticks.size());
+	EXPECT_TRUE(tester.runSummary(bound_robot, bound_rules).is_pruned);
+}
+
+TEST(StrategyTesterTest, RangeRunMatchesRunOnFewerTicks) {
+	Ticks ticks = createTicks();
+
+	Ticks first_half(ticks.begin(), ticks.begin() + ticks.size() / 2);
+	for (SimulationPeriod period : { SimulationPeriod::TICK, SimulationPeriod::S5 }) {
+		StrategyTester tester(&ticks, period, AccountProperties());
+		StrategyTester half_tester(&first_half, period, AccountProperties());
+		BreakoutRobot robot(0.002, ticks.size());
+		BreakoutRobot half_robot(0.002, ticks.size());
+		TradingSummary summary = tester.runSummary(robot, 0, first_half.size());
+		TradingResults half_results = half_tester.run(half_robot);
+		EXPECT_EQ(summary.account_balance, half_results.account_balance);
+		EXPECT_EQ(summary.trade_count, half_results.trades.size());
+
+		BreakoutRobot empty_robot(0.002, ticks.size());
+		EXPECT_EQ(tester.run(empty_robot, first_half.size(), first_half.size()).trades.size(), 0);
+	}
+}
+
+/**
+ * @brief Robot checking on its first tick whether the bars before the simulated range are available.
+ */
+class WarmUpRobot : public ATS {
+public:
+	ReturnCode start(BrokerConnection* broker_connection) override {
+		_broker = broker_connection;
+		return OK;
+	}
+
+	int onTick(const Tick& tick) override {
+		BarsView bars;
+		has_history = _broker->getLastBars(Timeframe::MIN1, 10, bars);
+		first_tick_timestamp = tick.timestamp;
+		return STOP;
+	}
+
+	void end() override {}
+
+	bool has_history = false;
+	TimePoint first_tick_timestamp;
+
+private:
+	BrokerConnection* _broker = nullptr;
+};
+
+TEST(StrategyTesterTest, TimeRangeRunFindsTicksByTimestamp) {
+	Ticks ticks = createTicks();
+
+	StrategyTester tester(&ticks, SimulationPeriod::TICK, AccountProperties());
+	TimePoint from = ticks[5000].timestamp - std::chrono::milliseconds(1);
+	TimePoint to = ticks[15000].timestamp;
+	auto [begin, end] = tester.findTickRange(from, to);
+	EXPECT_EQ(begin, 5000);
+	EXPECT_EQ(end, 15000);
+	auto [reversed_begin, reversed_end] = tester.findTickRange(to, from);
+	EXPECT_EQ(reversed_begin, 15000);
+	EXPECT_EQ(reversed_end, 15000);
+	auto [all_begin, all_end] = tester.findTickRange(ticks.front().timestamp - std::chrono::hours(1), ticks.front().timestamp + std::chrono::hours(24));
+	EXPECT_EQ(all_begin, 0);
+	EXPECT_EQ(all_end, ticks.size());
+
+	BreakoutRobot robot(0.002, ticks.size());
+	BreakoutRobot index_robot(0.002, ticks.size());
+	TradingResults results = tester.run(robot, from, to);
+	EXPECT_EQ(results.account_balance, tester.run(index_robot, 5000, 15000).account_balance);
+	for (const Trade& trade : results.trades) {
+		EXPECT_TRUE(trade.open_time >= from && trade.close_time <= to);
+	}
+
+	WarmUpRobot warm_up_robot;
+	tester.run(warm_up_robot, from, to);
+	EXPECT_TRUE(warm_up_robot.has_history);
+	EXPECT_EQ(warm_up_robot.first_tick_timestamp, ticks[5000].timestamp);
+}
+
+/**
+ * @brief Robot opening one short position on its first tick.
+ */
+class ShortRobot : public ATS {
+public:
+	ReturnCode start(BrokerConnection* broker_connection) override {
+		_broker = broker_connection;
+		return OK;
+	}
+
+	int onTick(const Tick&) override {
+		if (!_is_open) {
+			Order order;
+			order.volume = 1000;
+			order.is_long = false;
+			Position::Id id;
+			_is_open = _broker->tryCreatePosition(order, id);
+		}
+
+		return OK;
+	}
+
+	void end() override {
+		_broker->closeAllPositions();
+	}
+
+private:
+	BrokerConnection* _broker = nullptr;
+	bool _is_open = false;
+};
+
+TEST(StrategyTesterTest, ShortPositionOpensAtBidAndClosesAtAsk) {
+	Ticks ticks = createTicks(100);
+
+	StrategyTester tester(&ticks, SimulationPeriod::TICK, AccountProperties());
+	ShortRobot robot;
+	TradingResults results = tester.run(robot);
+	ASSERT_EQ(results.trades.size(), 1);
+	EXPECT_FALSE(results.trades[0].is_long);
+	EXPECT_EQ(results.trades[0].open_price, ticks.front().bid);
+	EXPECT_EQ(results.trades[0].close_price, ticks.back().ask);
+}
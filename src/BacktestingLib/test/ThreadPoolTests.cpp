@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+import Backtesting;
+
+using namespace Backtesting;
+
+TEST(ThreadPoolTest, RunsEveryJobOnce) {
+	ThreadPool thread_pool(4);
+	ASSERT_EQ(thread_pool.getWorkerCount(), 4);
+
+	// the pool is reused by consecutive runs
+	for (size_t count : { 0, 1, 3, 1000 }) {
+		std::vector<std::atomic<int>> runs(count);
+		std::atomic<bool> is_worker_id_valid = true;
+		thread_pool.parallelFor(count, [&](size_t index, size_t worker_id) {
+			runs[index]++;
+			if (worker_id >= thread_pool.getWorkerCount()) {
+				is_worker_id_valid = false;
+			}
+			});
+
+		EXPECT_TRUE(is_worker_id_valid);
+		for (const auto& run : runs) {
+			EXPECT_EQ(run, 1);
+		}
+	}
+}
+
+TEST(ThreadPoolTest, RethrowsExceptionOfJob) {
+	ThreadPool thread_pool(3);
+	EXPECT_THROW(thread_pool.parallelFor(100, [](size_t index, size_t) {
+		if (index == 42) {
+			throw std::runtime_error("failed job");
+		}
+		}), std::runtime_error);
+
+	std::atomic<size_t> count = 0;
+	thread_pool.parallelFor(10, [&](size_t, size_t) { count++; });
+	EXPECT_EQ(count, 10);
+}
@@ -1,6 +1,4 @@
 module;
-#include <deque>
-#include <stdexcept>
 #include <chrono>
 
 export module MovingAverageRobot;
@@ -9,127 +7,49 @@ export module MovingAverageRobot;
 import AlgoTrading;
 constexpr Timeframe UsedTimeframe = Timeframe::MIN5;
 /**
- * @brief Represents a helper class for calculating averages.
+ * @brief Number of moving average values needed for detecting crossovers.
  */
-class MovingAverage {
-public:
-	/**
-	 * @brief Number of stored MA values
-	 */
-	static const size_t N = 3;
-	MovingAverage() noexcept : _period() {}
-
-	/**
-	 * @brief Initializes the MovingAverage with the given bars and period.
-	 * @param bars the bars to use for initialization
-	 * @param period The period of the moving average
-	 */
-	void initialize(const BarsView bars, size_t period) {
-		_period = period;
-		if (bars.size() < N + period - 1) {
-			throw std::invalid_argument("Insufficient number of bars");
-		}
-
-		price accumulation = 0;
-		for (size_t i = 0; i < period; i++) {
-			price current_close = bars[i].close;
-			accumulation += current_close;
-			_last_prices.push_back(current_close);
-		}
-
-		price base_mean = accumulation / period;
-		_last_values.push_back(base_mean);
-
-		for (size_t i = period; i < period + N - 1; i++) {
-			price current_close = bars[i].close;
-			price old = addNewPrice(current_close);
-			price next_value = calculateNextValue(old, current_close, _last_values.back());
-			_last_values.push_back(next_value);
-		}
-	}
-
-	MovingAverage& operator=(MovingAverage&& other) noexcept = default;
+constexpr size_t N = 3;
 
-	enum CrossingState {
-		NO_CROSSING,
-		BULLISH, 
-		BEARISH
-	};
-
-	/**
-	* @brief Checks if the two moving averages have crossed.
-	* @param slower the slower moving average
-	* @param faster the faster moving average
-	* @return the crossing state
-	*/
-	static CrossingState have_crossed(const MovingAverage& slower, const MovingAverage& faster) {
-		if (slower[0] > faster[0]
-			&& slower[1] <= faster[1]
-			&& slower[2] < faster[2]) {
-			return BULLISH;
-		}
-
-		if (slower[0] < faster[0]
-			&& slower[1] >= faster[1]
-			&& slower[2] > faster[2]) {
-			return BEARISH;
-		}
-
-		return NO_CROSSING;
-	}	
-
-	/**
-	 * @brief Updates the moving average with the new bar.
-	 * @param bar the new bar.
-	 */
-	void add(const Bar& bar) {
-		price current_close = bar.close;
-		price old = addNewPrice(current_close);
-		price next_value = calculateNextValue(old, current_close, _last_values.back());
-		_last_values.pop_front();
-		_last_values.push_back(next_value);
-	}
+/**
+ * @brief Represents a state of crossing of two moving averages.
+ */
+enum CrossingState {
+	NO_CROSSING,
+	BULLISH,
+	BEARISH
+};
 
-	/**
-	 * @brief Gets a value of the moving average.
-	 * @param i index of the value
-	 * @return value of the moving average
-	 */
-	price operator[](size_t i) const {
-		return _last_values[i];
+/**
+* @brief Checks if the two moving averages have crossed.
+* @param slower last N values of the slower moving average
+* @param faster last N values of the faster moving average
+* @return the crossing state
+*/
+CrossingState have_crossed(IndicatorValues slower, IndicatorValues faster) {
+	if (slower[0] > faster[0]
+		&& slower[1] <= faster[1]
+		&& slower[2] < faster[2]) {
+		return BULLISH;
 	}
 
-private:
-	size_t _period;
-	std::deque<price> _last_values;
-	std::deque<price> _last_prices;
-
-	price addNewPrice(price new_price) {
-		price old = _last_prices.front();
-		_last_prices.pop_front();
-		_last_prices.push_back(new_price);
-		return old;
+	if (slower[0] < faster[0]
+		&& slower[1] >= faster[1]
+		&& slower[2] > faster[2]) {
+		return BEARISH;
 	}
 
-	price calculateNextValue(price old, price to_add, price current_mean) const {
-		return current_mean + ((to_add - old) / _period);
-	}
-};
+	return NO_CROSSING;
+}
 
 export class MovingAverageRobot : public ATS {
 private:
-	/**
-	 * @brief Number of additional bars needed for calculating crossovers
-	 */
-	static const size_t NUMBER_OF_ADDITIONAL_BARS = 2;
-
 	enum State {
-		WAITING_FOR_BARS,
 		TRADING,
 		WAITING_FOR_NEXT_BAR,
 	};
 
-	State _state = WAITING_FOR_BARS;
+	State _state = TRADING;
 	TimePoint _wait_for_timestamp;
 	BrokerConnection* _broker = nullptr;
 	size_t _short_period;
@@ -138,9 +58,6 @@ private:
 	float _allowed_risk_on_trade;
 	float _risk_reward_ratio;
 
-	MovingAverage _shortMA;
-	MovingAverage _longMA;
-
 	price findMinimumPrice() const;
 
 	price findMaximumPrice() const;
@@ -149,7 +66,7 @@ private:
 		return _allowed_risk_on_trade * _broker->getBalance() / price_difference;
 	}
 
-	void trade(const Tick& tick);
+	void trade(const Tick& tick, IndicatorValues long_ma, IndicatorValues short_ma);
 public:
 	/**
 	* @brief Constructs the MovingAverageRobot with the given parameters.
@@ -174,28 +91,19 @@ public:
 	}
 
 	int onTick(const Tick& tick) override {
-		// wait till we have N + K bars
 		BarsView view;
+		IndicatorValues short_ma;
+		IndicatorValues long_ma;
 
 		switch (_state)
 		{
-		case MovingAverageRobot::WAITING_FOR_BARS: {
-			BarsView short_view;
-			if (_broker->getLastBars(UsedTimeframe, _long_period + NUMBER_OF_ADDITIONAL_BARS, view)
-				&& _broker->getLastBars(UsedTimeframe, _short_period + NUMBER_OF_ADDITIONAL_BARS, short_view)) {
-				_shortMA.initialize(short_view, _short_period);
-				_longMA.initialize(view, _long_period);
-				_state = TRADING;
-			}
-			break;
-		}
 		case MovingAverageRobot::TRADING:
-			if (_broker->getLastBars(UsedTimeframe, 1, view)) {
-				const Bar& bar = view[0];
+			// the moving averages are shared by all the robots using the same periods, there is nothing to recalculate
+			if (_broker->getLastBars(UsedTimeframe, 1, view)
+				&& _broker->getLastIndicatorValues(Indicator::SMA, UsedTimeframe, _short_period, N, short_ma)
+				&& _broker->getLastIndicatorValues(Indicator::SMA, UsedTimeframe, _long_period, N, long_ma)) {
 				_wait_for_timestamp = view[0].open_timestamp + timeframe_durations[(int)UsedTimeframe];
-				_shortMA.add(bar);
-				_longMA.add(bar);
-				trade(tick);
+				trade(tick, long_ma, short_ma);
 				_state = WAITING_FOR_NEXT_BAR;
 			}
 			break;
@@ -217,51 +125,40 @@ public:
 
 price MovingAverageRobot::findMinimumPrice() const
 {
-	BarsView view;
-	_broker->getLastBars(UsedTimeframe, _long_period, view);
-	price min = view.front().low;
-	for (const Bar& bar : view) {
-		if (bar.low < min) {
-			min = bar.low;
-		}
-	}
-
-	return min;
+	// the rolling extremes are calculated once for the whole series, a lookup does not scan the period
+	IndicatorValues lowest;
+	_broker->getLastIndicatorValues(Indicator::LOWEST_LOW, UsedTimeframe, _long_period, 1, lowest);
+	return lowest[0];
 }
 
 price MovingAverageRobot::findMaximumPrice() const
 {
-	BarsView view;
-	_broker->getLastBars(UsedTimeframe, _long_period, view);
-	price max = view.front().low;
-	for (const Bar& bar : view) {
-		if (bar.high > max) {
-			max = bar.low;
-		}
-	}
-
-	return max;
+	IndicatorValues highest;
+	_broker->getLastIndicatorValues(Indicator::HIGHEST_HIGH, UsedTimeframe, _long_period, 1, highest);
+	return highest[0];
 }
 
 /**
  * @brief Trades based on the moving averages
  * @param tick the current tick
+ * @param long_ma last N values of the long moving average
+ * @param short_ma last N values of the short moving average
  */
-void MovingAverageRobot::trade(const Tick& tick) {
+void MovingAverageRobot::trade(const Tick& tick, IndicatorValues long_ma, IndicatorValues short_ma) {
 	bool should_place_order = false;
 	price stoploss_current_difference = 0;
 	Order order;
 
-	switch (MovingAverage::have_crossed(_longMA, _shortMA))
+	switch (have_crossed(long_ma, short_ma))
 	{
-	case MovingAverage::CrossingState::BULLISH:
+	case CrossingState::BULLISH:
 		order.stoploss = findMinimumPrice();
 		order.is_long = true;
 		stoploss_current_difference = tick.bid - order.stoploss;
 		order.takeprofit = tick.bid + stoploss_current_difference * _risk_reward_ratio;
 		should_place_order = true;
 		break;
-	case MovingAverage::CrossingState::BEARISH:
+	case CrossingState::BEARISH:
 		order.stoploss = findMaximumPrice();
 		order.is_long = false;
 		stoploss_current_difference = order.stoploss - tick.ask;
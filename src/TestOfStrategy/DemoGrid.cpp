@@ -0,0 +1,166 @@
+module;
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <span>
+
+export module DemoGrid;
+
+import AlgoTrading;
+import MovingAverageRobot;
+import ParameterSpace;
+import StrategyTester;
+
+/**
+ * @brief Structure for storing parameters of the MovingAverageRobot.
+ */
+export struct MovingAverageRobotParameters {
+	size_t fast_MA_period;
+	size_t slow_MA_period;
+	float allowed_loss_on_trade;
+	float risk_reward_ratio;
+};
+
+/**
+ * @brief Generates combinations of parameters for the MovingAverageRobot.
+ * @return Vector of parameter combinations.
+ */
+export std::vector<MovingAverageRobotParameters> getParameterCombinations() {
+	std::vector<MovingAverageRobotParameters> parameter_combinations;
+	for (size_t fast_MA_period = 5; fast_MA_period < 12; fast_MA_period++) {
+		for (size_t slow_MA_period = 12; slow_MA_period < 40; slow_MA_period++) {
+			for (float allowed_loss_on_trade = 0.005; allowed_loss_on_trade < 0.025; allowed_loss_on_trade += 0.005) {
+				for (float risk_reward_ratio = 1; risk_reward_ratio < 2; risk_reward_ratio += 0.2) {
+					parameter_combinations.emplace_back(
+						fast_MA_period,
+						slow_MA_period,
+						allowed_loss_on_trade,
+						risk_reward_ratio);
+				}
+			}
+		}
+	}
+
+	return parameter_combinations;
+}
+
+/**
+ * @brief Describes the ranges of the demo grid without materializing its combinations.
+ * @return The parameter space of the MovingAverageRobot.
+ */
+export Backtesting::ParameterSpace getParameterSpace() {
+	return Backtesting::ParameterSpace({
+		{ 5, 11, 1 },
+		{ 12, 39, 1 },
+		{ 0.005, 0.02, 0.005 },
+		{ 1, 1.8, 0.2 } });
+}
+
+/**
+ * @brief Creates parameters of the MovingAverageRobot from the values of its parameter space.
+ * @param values Values of the parameters in the order of getParameterSpace.
+ * @return The parameters.
+ */
+export MovingAverageRobotParameters createRobotParameters(std::span<const double> values) {
+	return MovingAverageRobotParameters(
+		static_cast<size_t>(values[0]),
+		static_cast<size_t>(values[1]),
+		static_cast<float>(values[2]),
+		static_cast<float>(values[3]));
+}
+
+/**
+ * @brief Creates a MovingAverageRobot with given parameters.
+ * @param params Parameters for the robot.
+ * @return Created robot.
+ */
+export MovingAverageRobot createRobot(MovingAverageRobotParameters params) {
+	return MovingAverageRobot(
+		params.fast_MA_period,
+		params.slow_MA_period,
+		params.allowed_loss_on_trade,
+		params.risk_reward_ratio);
+}
+
+/**
+ * @brief Calculates the indicators of the MovingAverageRobots with the given parameters in advance.
+ * @note The robots request the moving averages of both their periods and the extremes of their slow period,
+ * every period of the combinations is calculated once before the simulation runs are fanned out.
+ * @param tester The tester running the robots.
+ * @param combinations Parameters of the robots.
+ */
+export void precomputeRobotIndicators(Backtesting::StrategyTester& tester, std::span<const MovingAverageRobotParameters> combinations) {
+	std::vector<size_t> average_periods;
+	std::vector<size_t> slow_periods;
+	for (const MovingAverageRobotParameters& params : combinations) {
+		average_periods.push_back(params.fast_MA_period);
+		average_periods.push_back(params.slow_MA_period);
+		slow_periods.push_back(params.slow_MA_period);
+	}
+
+	for (std::vector<size_t>* periods : { &average_periods, &slow_periods }) {
+		std::sort(periods->begin(), periods->end());
+		periods->erase(std::unique(periods->begin(), periods->end()), periods->end());
+	}
+
+	tester.precomputeIndicators(Indicator::SMA, Timeframe::MIN5, average_periods);
+	tester.precomputeIndicators(Indicator::LOWEST_LOW, Timeframe::MIN5, slow_periods);
+	tester.precomputeIndicators(Indicator::HIGHEST_HIGH, Timeframe::MIN5, slow_periods);
+}
+
+/**
+ * @brief Predicts relative cost of simulating a MovingAverageRobot with given parameters.
+ * @note Averages of close periods cross more often, so the robot trades (and its trading manager works) more.
+ * @param params Parameters for the robot.
+ * @return the predicted cost, only its ordering matters.
+ */
+export double estimateRobotCost(const MovingAverageRobotParameters& params) {
+	return 1.0 / (params.slow_MA_period - params.fast_MA_period);
+}
+
+/**
+ * @brief Randomly changes one parameter of the MovingAverageRobot within the ranges of the demo grid.
+ * @param params Parameters for the robot.
+ * @param random_generator The random generator.
+ * @return Changed parameters.
+ */
+export MovingAverageRobotParameters mutateRobotParameters(const MovingAverageRobotParameters& params, std::mt19937_64& random_generator) {
+	MovingAverageRobotParameters mutated = params;
+	std::uniform_int_distribution<int> step(-2, 2);
+	switch (std::uniform_int_distribution<int>(0, 3)(random_generator)) {
+	case 0:
+		mutated.fast_MA_period = std::clamp<int>(static_cast<int>(params.fast_MA_period) + step(random_generator), 5, 11);
+		break;
+	case 1:
+		mutated.slow_MA_period = std::clamp<int>(static_cast<int>(params.slow_MA_period) + step(random_generator), 12, 39);
+		break;
+	case 2:
+		mutated.allowed_loss_on_trade = std::clamp(params.allowed_loss_on_trade + 0.005f * step(random_generator), 0.005f, 0.02f);
+		break;
+	default:
+		mutated.risk_reward_ratio = std::clamp(params.risk_reward_ratio + 0.2f * step(random_generator), 1.0f, 1.8f);
+		break;
+	}
+
+	return mutated;
+}
+
+/**
+ * @brief Combines parameters of two MovingAverageRobots - every parameter is taken from one of the parents.
+ * @param a Parameters of the first parent.
+ * @param b Parameters of the second parent.
+ * @param random_generator The random generator.
+ * @return Parameters of the child.
+ */
+export MovingAverageRobotParameters crossRobotParameters(
+	const MovingAverageRobotParameters& a,
+	const MovingAverageRobotParameters& b,
+	std::mt19937_64& random_generator) {
+	std::bernoulli_distribution from_a(0.5);
+	return MovingAverageRobotParameters(
+		from_a(random_generator) ? a.fast_MA_period : b.fast_MA_period,
+		from_a(random_generator) ? a.slow_MA_period : b.slow_MA_period,
+		from_a(random_generator) ? a.allowed_loss_on_trade : b.allowed_loss_on_trade,
+		from_a(random_generator) ? a.risk_reward_ratio : b.risk_reward_ratio);
+}
@@ -0,0 +1,322 @@
+module;
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <filesystem>
+#include <system_error>
+#include <type_traits>
+#include <stdexcept>
+#include <chrono>
+
+export module TickCache;
+
+import AlgoTrading;
+import Utils;
+import TickParser;
+
+using namespace std;
+using namespace utils;
+
+/**
+ * @brief Header of the binary tick cache file, it is followed by tick_count raw Tick records.
+ */
+struct TickCacheHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t tick_size;
+	uint64_t tick_count;
+	uint64_t timestamp_ticks_per_second;
+	uint64_t source_size;
+	int64_t source_modification_time;
+	uint64_t source_hash;
+};
+
+constexpr char TICK_CACHE_MAGIC[8] = { 'B', 'T', 'T', 'I', 'C', 'K', 'S', '\0' };
+
+static_assert(std::is_trivially_copyable_v<Tick>, "Ticks are stored in the cache as raw bytes.");
+static_assert(sizeof(TickCacheHeader) % alignof(Tick) == 0, "Ticks following the header have to stay aligned.");
+
+/**
+ * @brief Calculates 64-bit FNV-1a hash of the given data.
+ * @param data data to hash
+ * @return hash of the data
+ */
+uint64_t hashContent(string_view data) {
+	uint64_t hash = 14695981039346656037ull;
+	for (unsigned char c : data) {
+		hash ^= c;
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+/**
+ * @brief Specifies how the cache is validated against its source csv file.
+ */
+export enum class CacheValidation {
+	// the size and the modification time of the source are compared with the cache,
+	// the content is hashed only if the time differs (e.g. the file was copied or touched), the time stored
+	// in the cache is refreshed when the content matches
+	METADATA,
+	// the content of the source is hashed on every load
+	CONTENT
+};
+
+/**
+ * @brief Binary on-disk cache of parsed ticks.
+ *
+ * The first load of a csv file parses it using TickParser::getTicksParallel and stores the ticks next to it in a versioned
+ * binary format, later loads memory map the cache and expose it as TicksView without any per-tick work.
+ * The cache carries the size, the modification time and a content hash of the source csv file, so stale caches
+ * are detected and rebuilt.
+ */
+export class TickCache {
+public:
+	/**
+	 * @brief Version of the binary format, has to be increased with any change of the layout.
+	 */
+	static constexpr uint32_t FORMAT_VERSION = 2;
+
+	/**
+	 * @brief Constructs the cache.
+	 * @param validation how the cache is validated against its source.
+	 */
+	explicit TickCache(CacheValidation validation = CacheValidation::METADATA) noexcept : _validation(validation) {}
+
+	/**
+	 * @brief Gets the path of the cache file that is used for the given csv file by default.
+	 * @param csv_path The path to the csv file with ticks.
+	 * @return path of the cache file.
+	 */
+	static std::string getDefaultCachePath(const std::string& csv_path) {
+		return csv_path + ".ticks";
+	}
+
+	/**
+	 * @brief Loads ticks of the given csv file, the cache is stored in the default location.
+	 * @param csv_path The path to the csv file with ticks.
+	 * @return view of the loaded ticks - valid until the next load or destruction of the cache; empty on failure.
+	 */
+	TicksView load(const std::string& csv_path) {
+		return load(csv_path, getDefaultCachePath(csv_path));
+	}
+
+	/**
+	 * @brief Loads ticks of the given csv file using the given cache file.
+	 * @param csv_path The path to the csv file with ticks.
+	 * @param cache_path The path to the binary cache file.
+	 * @return view of the loaded ticks - valid until the next load or destruction of the cache; empty on failure.
+	 */
+	TicksView load(const std::string& csv_path, const std::string& cache_path);
+
+	/**
+	 * @brief Gets the ticks loaded by the last load.
+	 * @return view of the loaded ticks.
+	 */
+	TicksView getTicks() const {
+		return _ticks;
+	}
+
+	/**
+	 * @brief Specifies whether the last load was served from an up to date cache.
+	 * @return True if the csv file did not have to be parsed, otherwise false.
+	 */
+	bool wasLoadedFromCache() const {
+		return _loaded_from_cache;
+	}
+
+private:
+	/**
+	 * @brief Size and modification time of the source csv file.
+	 */
+	struct SourceStamp {
+		uint64_t size;
+		int64_t modification_time;
+	};
+
+	CacheValidation _validation;
+	MemoryMappedFile _mapping;
+	Ticks _owned_ticks;
+	TicksView _ticks;
+	bool _loaded_from_cache = false;
+
+	static bool tryGetSourceStamp(const std::string& csv_path, SourceStamp& stamp);
+
+	static bool tryHashSource(const std::string& csv_path, uint64_t& source_hash);
+
+	bool tryMapCache(const std::string& cache_path, const std::string& csv_path, const SourceStamp& stamp);
+
+	bool tryWriteCache(const std::string& cache_path, const Ticks& ticks, const SourceStamp& stamp, uint64_t source_hash) const;
+
+	static bool tryWriteModificationTime(const std::string& cache_path, int64_t modification_time);
+
+	static TickCacheHeader createHeader(uint64_t tick_count, const SourceStamp& stamp, uint64_t source_hash) {
+		TickCacheHeader header{};
+		std::memcpy(header.magic, TICK_CACHE_MAGIC, sizeof(header.magic));
+		header.version = FORMAT_VERSION;
+		header.tick_size = sizeof(Tick);
+		header.tick_count = tick_count;
+		header.timestamp_ticks_per_second = TimePoint::period::den / TimePoint::period::num;
+		header.source_size = stamp.size;
+		header.source_modification_time = stamp.modification_time;
+		header.source_hash = source_hash;
+		return header;
+	}
+};
+
+TicksView TickCache::load(const std::string& csv_path, const std::string& cache_path) {
+	_ticks = TicksView();
+	_owned_ticks.clear();
+	_mapping = MemoryMappedFile();
+	_loaded_from_cache = false;
+
+	SourceStamp stamp;
+	if (!tryGetSourceStamp(csv_path, stamp)) {
+		return _ticks;
+	}
+
+	if (tryMapCache(cache_path, csv_path, stamp)) {
+		_loaded_from_cache = true;
+		return _ticks;
+	}
+
+	TickParser tick_parser;
+	Ticks ticks = tick_parser.getTicksParallel(csv_path);
+	if (ticks.empty()) {
+		return _ticks;
+	}
+
+	uint64_t source_hash;
+	if (tryHashSource(csv_path, source_hash)
+		&& tryWriteCache(cache_path, ticks, stamp, source_hash)
+		&& tryMapCache(cache_path, csv_path, stamp)) {
+		return _ticks;
+	}
+
+	// the cache could not be stored (e.g. read-only location), serve the parsed ticks directly
+	_owned_ticks = std::move(ticks);
+	_ticks = TicksView(_owned_ticks);
+	return _ticks;
+}
+
+bool TickCache::tryGetSourceStamp(const std::string& csv_path, SourceStamp& stamp) {
+	std::error_code ec;
+	stamp.size = std::filesystem::file_size(csv_path, ec);
+	if (ec) {
+		return false;
+	}
+
+	stamp.modification_time = std::filesystem::last_write_time(csv_path, ec).time_since_epoch().count();
+	return !ec;
+}
+
+bool TickCache::tryHashSource(const std::string& csv_path, uint64_t& source_hash) {
+	try {
+		MemoryMappedFile source(csv_path);
+		source_hash = hashContent(source.view());
+	}
+	catch (const CanNotMapFileError&) {
+		return false;
+	}
+
+	return true;
+}
+
+bool TickCache::tryMapCache(const std::string& cache_path, const std::string& csv_path, const SourceStamp& stamp) {
+	MemoryMappedFile mapping;
+	try {
+		mapping = MemoryMappedFile(cache_path);
+	}
+	catch (const CanNotMapFileError&) {
+		return false;
+	}
+
+	if (mapping.size() < sizeof(TickCacheHeader)) {
+		return false;
+	}
+
+	TickCacheHeader header;
+	std::memcpy(&header, mapping.data(), sizeof(header));
+	TickCacheHeader expected = createHeader(header.tick_count, stamp, header.source_hash);
+	bool is_same_time = header.source_modification_time == stamp.modification_time;
+	expected.source_modification_time = header.source_modification_time;
+	if (std::memcmp(&header, &expected, sizeof(header)) != 0
+		|| mapping.size() != sizeof(TickCacheHeader) + header.tick_count * sizeof(Tick)) {
+		return false;
+	}
+
+	// the content is read only when the metadata cannot prove the cache is current
+	if (_validation == CacheValidation::CONTENT || !is_same_time) {
+		uint64_t source_hash;
+		if (!tryHashSource(csv_path, source_hash) || source_hash != header.source_hash) {
+			return false;
+		}
+	}
+
+	if (!is_same_time) {
+		// the stamp of the current cache is refreshed, so the next loads are validated by the metadata again,
+		// the mapping is released for the write because it does not share the file for writing on all platforms
+		mapping = MemoryMappedFile();
+		tryWriteModificationTime(cache_path, stamp.modification_time);
+		try {
+			mapping = MemoryMappedFile(cache_path);
+		}
+		catch (const CanNotMapFileError&) {
+			return false;
+		}
+
+		if (mapping.size() != sizeof(TickCacheHeader) + header.tick_count * sizeof(Tick)) {
+			return false;
+		}
+	}
+
+	auto first_tick = reinterpret_cast<const Tick*>(mapping.data() + sizeof(TickCacheHeader));
+	_ticks = TicksView(first_tick, header.tick_count);
+	_mapping = std::move(mapping);
+	return true;
+}
+
+bool TickCache::tryWriteCache(const std::string& cache_path, const Ticks& ticks, const SourceStamp& stamp, uint64_t source_hash) const {
+	// write into a temporary file first, so a concurrent or interrupted run never sees a partial cache
+	std::string tmp_path = cache_path + ".tmp";
+	{
+		std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+		if (!ofs) {
+			return false;
+		}
+
+		TickCacheHeader header = createHeader(ticks.size(), stamp, source_hash);
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		ofs.write(reinterpret_cast<const char*>(ticks.data()), ticks.size() * sizeof(Tick));
+		if (!ofs) {
+			std::error_code ec;
+			std::filesystem::remove(tmp_path, ec);
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmp_path, cache_path, ec);
+	if (ec) {
+		std::filesystem::remove(tmp_path, ec);
+		return false;
+	}
+
+	return true;
+}
+
+bool TickCache::tryWriteModificationTime(const std::string& cache_path, int64_t modification_time) {
+	std::fstream fs(cache_path, std::ios::binary | std::ios::in | std::ios::out);
+	if (!fs) {
+		return false;
+	}
+
+	fs.seekp(offsetof(TickCacheHeader, source_modification_time));
+	fs.write(reinterpret_cast<const char*>(&modification_time), sizeof(modification_time));
+	return static_cast<bool>(fs);
+}
@@ -6,6 +6,18 @@ module;
 #include <filesystem>
 #include <format>
 #include <chrono>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <stdexcept>
+#include <algorithm>
+#include <execution>
+#include <limits>
+#include <cmath>
+#include <thread>
+#include <system_error>
+#include <fstream>
+#include <span>
 
 export module TickParser;
 
@@ -15,11 +27,47 @@ import Utils;
 using namespace std;
 using namespace utils;
 
+/**
+ * @brief Durations of the phases of the last parallel load in milliseconds.
+ */
+export struct TickLoadTimings {
+	/**
+	 * @brief Mapping of the file and splitting it into newline-aligned chunks.
+	 */
+	double splitting_ms = 0;
+
+	/**
+	 * @brief Parallel parsing of the chunks.
+	 */
+	double parsing_ms = 0;
+
+	/**
+	 * @brief Carrying forward of empty cells across chunk boundaries and copying chunks into the result.
+	 */
+	double stitching_ms = 0;
+
+	/**
+	 * @brief Whole load.
+	 */
+	double total_ms = 0;
+
+	/**
+	 * @brief Count of chunks the file was split into.
+	 */
+	size_t chunk_count = 0;
+};
+
 /**
  * @brief Represents a parser for ticks in the specified custom format.
  */
 export class TickParser {
+	friend class TickFileSource;
+
 public:
+	/**
+	 * @brief Files of at least this size are loaded by getTicks in parallel.
+	 */
+	static constexpr uintmax_t PARALLEL_LOADING_THRESHOLD = 64 * 1024 * 1024;
 
 	TickParser() {
 		_intermediate_tick.timestamp = std::chrono::system_clock::now();
@@ -31,13 +79,30 @@ public:
 
 	/**
 	* @brief Parses the ticks from the specified file.
+	* @note Large files (see PARALLEL_LOADING_THRESHOLD) are parsed by getTicksParallel.
 	* @param path The path to the file with ticks.
 	* @return The parsed ticks.
 	*/
 	Ticks getTicks(const std::string& path) {
+		std::error_code ec;
+		uintmax_t file_size = std::filesystem::file_size(path, ec);
+		if (!ec && file_size >= PARALLEL_LOADING_THRESHOLD) {
+			return getTicksParallel(path);
+		}
+
+		return getTicksSequential(path);
+	}
+
+	/**
+	* @brief Parses the ticks from the specified file row by row on the calling thread.
+	* @note getTicks uses it for files below PARALLEL_LOADING_THRESHOLD, a file of any size can be parsed by it on one thread.
+	* @param path The path to the file with ticks.
+	* @return The parsed ticks.
+	*/
+	Ticks getTicksSequential(const std::string& path) {
 		Ticks ticks;
 		try {
-			CSVParser parser(path, 6, '\t', true);
+			CSVParser parser(path, 6, '\t', true, CSVParser::MEMORY_MAPPED);
 			RowStream row_stream = parser.getRowStream();
 			Row row;
 			while (row_stream) {
@@ -52,8 +117,417 @@ public:
 		return ticks;
 	}
 
+	/**
+	* @brief Parses the ticks from the specified file directly from its memory mapped bytes.
+	* @note Decodes the fixed `YYYY.MM.DD HH:MM:SS.mmm` timestamp layout without any per-row allocation,
+	* produces the same ticks as getTicks, milliseconds are kept.
+	* @param path The path to the file with ticks.
+	* @return The parsed ticks.
+	*/
+	Ticks getTicksFast(const std::string& path) {
+		Ticks ticks;
+		try {
+			MemoryMappedFile file(path);
+			string_view data = file.view();
+
+			// skip the header line
+			size_t header_end = data.find('\n');
+			if (header_end == string_view::npos) {
+				return ticks;
+			}
+
+			data.remove_prefix(header_end + 1);
+
+			// rows have at least 30 bytes, reserving avoids most of the reallocations
+			ticks.reserve(data.size() / 32);
+			parseRows(data, _intermediate_tick, ticks);
+		}
+		catch (const std::runtime_error&) {
+			return ticks;
+		}
+
+		return ticks;
+	}
+
+	/**
+	* @brief Parses the ticks from the specified file by newline-aligned chunks in parallel.
+	* @note Produces the same ticks as getTicks, empty cells at the start of a chunk are carried forward
+	* from the previous chunk while stitching. Durations of the phases are available via getLastLoadTimings.
+	* @param path The path to the file with ticks.
+	* @param min_chunk_size The smallest size of a chunk in bytes.
+	* @return The parsed ticks.
+	*/
+	Ticks getTicksParallel(const std::string& path, size_t min_chunk_size = MIN_CHUNK_SIZE) {
+		using namespace std::chrono;
+
+		_last_load_timings = TickLoadTimings();
+		auto start = steady_clock::now();
+		Ticks ticks;
+		try {
+			MemoryMappedFile file(path);
+			string_view data = file.view();
+
+			// skip the header line
+			size_t header_end = data.find('\n');
+			if (header_end == string_view::npos) {
+				return ticks;
+			}
+
+			data.remove_prefix(header_end + 1);
+			vector<ParsedChunk> chunks = splitIntoChunks(data, min_chunk_size);
+			auto split_end = steady_clock::now();
+
+			std::for_each(std::execution::par, chunks.begin(), chunks.end(), parseChunk);
+			auto parse_end = steady_clock::now();
+
+			ticks = stitchChunks(chunks);
+			auto stitch_end = steady_clock::now();
+
+			_last_load_timings.splitting_ms = duration<double, milli>(split_end - start).count();
+			_last_load_timings.parsing_ms = duration<double, milli>(parse_end - split_end).count();
+			_last_load_timings.stitching_ms = duration<double, milli>(stitch_end - parse_end).count();
+			_last_load_timings.chunk_count = chunks.size();
+		}
+		catch (const std::runtime_error&) {
+			return ticks;
+		}
+
+		_last_load_timings.total_ms = duration<double, milli>(steady_clock::now() - start).count();
+		return ticks;
+	}
+
+	/**
+	 * @brief Gets durations of the phases of the last parallel load.
+	 * @return timings of the last parallel load.
+	 */
+	const TickLoadTimings& getLastLoadTimings() const {
+		return _last_load_timings;
+	}
+
 private:
+	static constexpr size_t DATE_LENGTH = 10; // YYYY.MM.DD
+	static constexpr size_t TIME_LENGTH = 12; // HH:MM:SS.mmm
+
+	/**
+	 * @brief Chunks are not made smaller than this, so the splitting and stitching overhead stays negligible.
+	 */
+	static constexpr size_t MIN_CHUNK_SIZE = 4 * 1024 * 1024;
+
+	/**
+	 * @brief Several chunks per worker balance the load when the rows are not evenly dense.
+	 */
+	static constexpr size_t CHUNKS_PER_WORKER = 4;
+
+	/**
+	 * @brief Marks values that were not yet known when a chunk was parsed.
+	 */
+	static constexpr price UNSET_PRICE = std::numeric_limits<price>::quiet_NaN();
+	static constexpr volume UNSET_VOLUME = std::numeric_limits<volume>::max();
+
+	/**
+	 * @brief Chunk of the file and its parsed ticks.
+	 */
+	struct ParsedChunk {
+		string_view data;
+		Ticks ticks;
+
+		/**
+		 * @brief False if the parsing stopped before the end of the chunk (empty line or malformatted row).
+		 */
+		bool complete = true;
+
+		/**
+		 * @brief Index of the first tick of the chunk in the stitched result.
+		 */
+		size_t offset = 0;
+
+		/**
+		 * @brief The last tick of the previous chunk with its values filled, the unset values are taken from it.
+		 */
+		Tick carry_in;
+	};
+
 	Tick _intermediate_tick;
+	char _cached_date[DATE_LENGTH] = {};
+	TimePoint _cached_day;
+	TickLoadTimings _last_load_timings;
+
+	/**
+	 * @brief Splits the rows into chunks ending at a newline.
+	 * @param data rows to split.
+	 * @param min_chunk_size the smallest size of a chunk.
+	 * @return chunks covering the whole data.
+	 */
+	static vector<ParsedChunk> splitIntoChunks(string_view data, size_t min_chunk_size) {
+		size_t workers = std::max(1u, std::thread::hardware_concurrency());
+		size_t chunk_count = std::clamp<size_t>(data.size() / std::max<size_t>(min_chunk_size, 1), 1, workers * CHUNKS_PER_WORKER);
+
+		vector<ParsedChunk> chunks;
+		chunks.reserve(chunk_count);
+		size_t begin = 0;
+		for (size_t i = 1; i <= chunk_count && begin < data.size(); ++i) {
+			size_t end = data.size();
+			if (i < chunk_count) {
+				end = data.find('\n', std::max(data.size() / chunk_count * i, begin));
+				end = end == string_view::npos ? data.size() : end + 1;
+			}
+
+			chunks.emplace_back(data.substr(begin, end - begin));
+			begin = end;
+		}
+
+		return chunks;
+	}
+
+	/**
+	 * @brief Parses one chunk, values of empty cells preceding the first filled one are left unset.
+	 * @param chunk the chunk to parse.
+	 */
+	static void parseChunk(ParsedChunk& chunk) {
+		// every chunk needs its own parser - the decoded date is cached in it
+		TickParser chunk_parser;
+		Tick intermediate_tick = chunk_parser._intermediate_tick;
+		intermediate_tick.bid = UNSET_PRICE;
+		intermediate_tick.ask = UNSET_PRICE;
+		intermediate_tick.volume = UNSET_VOLUME;
+
+		chunk.ticks.reserve(chunk.data.size() / 32);
+		try {
+			chunk.complete = chunk_parser.parseRows(chunk.data, intermediate_tick, chunk.ticks);
+		}
+		catch (const std::runtime_error&) {
+			// keep the ticks preceding the malformatted row as the sequential parsing does
+			chunk.complete = false;
+		}
+	}
+
+	/**
+	 * @brief Carries values forward across chunk boundaries and joins the chunks in order.
+	 * @param chunks parsed chunks.
+	 * @return the stitched ticks.
+	 */
+	Ticks stitchChunks(vector<ParsedChunk>& chunks) {
+		// only the last tick of every chunk is filled serially, the chunks are filled while copied in parallel
+		// the sequential parsing stops on the first incomplete chunk, so the following ones are dropped
+		size_t used_chunks = 0;
+		size_t tick_count = 0;
+		Tick previous = _intermediate_tick;
+		for (auto& chunk : chunks) {
+			chunk.carry_in = previous;
+			if (!chunk.ticks.empty()) {
+				previous = chunk.ticks.back();
+				fillUnsetValues(previous, chunk.carry_in);
+			}
+
+			chunk.offset = tick_count;
+			tick_count += chunk.ticks.size();
+			++used_chunks;
+			if (!chunk.complete) {
+				break;
+			}
+		}
+
+		_intermediate_tick = previous;
+		if (used_chunks == 1) {
+			ParsedChunk& chunk = chunks.front();
+			fillUnsetValues(chunk.ticks, chunk.carry_in);
+			return std::move(chunk.ticks);
+		}
+
+		Ticks ticks(tick_count);
+		std::for_each(std::execution::par, chunks.begin(), chunks.begin() + used_chunks, [&ticks](const ParsedChunk& chunk) {
+			auto first = ticks.begin() + chunk.offset;
+			std::copy(chunk.ticks.begin(), chunk.ticks.end(), first);
+			fillUnsetValues(std::span(first, chunk.ticks.size()), chunk.carry_in);
+			});
+
+		return ticks;
+	}
+
+	/**
+	 * @brief Fills values that were unset at the start of a chunk from the last tick of the previous chunk.
+	 * @note Once a value of a column is known it is carried forward within the chunk, so every column is filled
+	 * only up to its first set value. A column that is empty in the whole chunk (e.g. the volume) is filled in every tick.
+	 * @param ticks ticks of the chunk.
+	 * @param carry_in the last tick of the previous chunk.
+	 */
+	static void fillUnsetValues(std::span<Tick> ticks, const Tick& carry_in) {
+		bool is_bid_unset = true;
+		bool is_ask_unset = true;
+		bool is_volume_unset = true;
+		for (auto& tick : ticks) {
+			is_bid_unset = is_bid_unset && std::isnan(tick.bid);
+			is_ask_unset = is_ask_unset && std::isnan(tick.ask);
+			is_volume_unset = is_volume_unset && tick.volume == UNSET_VOLUME;
+			if (!is_bid_unset && !is_ask_unset && !is_volume_unset) {
+				break;
+			}
+
+			fillUnsetValues(tick, carry_in);
+		}
+	}
+
+	/**
+	 * @brief Fills unset values of one tick.
+	 * @param tick the tick to fill.
+	 * @param carry_in the tick to take the unset values from.
+	 */
+	static void fillUnsetValues(Tick& tick, const Tick& carry_in) {
+		if (std::isnan(tick.bid)) {
+			tick.bid = carry_in.bid;
+		}
+
+		if (std::isnan(tick.ask)) {
+			tick.ask = carry_in.ask;
+		}
+
+		if (tick.volume == UNSET_VOLUME) {
+			tick.volume = carry_in.volume;
+		}
+	}
+
+	/**
+	 * @brief Parses complete rows of the tick file.
+	 * @param data rows to parse, parsing ends on an empty line or at the end of the data.
+	 * @param intermediate_tick state of the last tick - empty cells are carried forward from it.
+	 * @param ticks output parameter - parsed ticks are appended to it.
+	 * @return True if all the data were parsed, false if the parsing ended on an empty line.
+	 * @throws format_error if a row is malformatted.
+	 */
+	bool parseRows(string_view data, Tick& intermediate_tick, Ticks& ticks) {
+		const char* current = data.data();
+		const char* const end = data.data() + data.size();
+		while (current != end && *current != '\n' && *current != '\r') {
+			const char* line_end = static_cast<const char*>(std::memchr(current, '\n', end - current));
+			if (line_end == nullptr) {
+				line_end = end;
+			}
+
+			const char* row_end = line_end;
+			if (row_end != current && row_end[-1] == '\r') {
+				--row_end;
+			}
+
+			parseRow(current, row_end, intermediate_tick);
+			ticks.push_back(intermediate_tick);
+			current = line_end == end ? end : line_end + 1;
+		}
+
+		return current == end;
+	}
+
+	/**
+	 * @brief Throws the error of a malformatted timestamp.
+	 * @throws format_error always.
+	 */
+	[[noreturn]] static void throwTimestampFormatError() {
+		throw format_error("Unexpected format of timestamps - conversion failed.");
+	}
+
+	/**
+	 * @brief Parses one row - format of the csv file: <DATE>	<TIME>	<BID>	<ASK>	<LAST>	<VOLUME>	<FLAGS>
+	 * @param current pointer to the first character of the row.
+	 * @param row_end pointer behind the last character of the row.
+	 * @param tick tick to update, empty cells keep its values.
+	 */
+	void parseRow(const char* current, const char* row_end, Tick& tick) {
+		if (row_end - current < static_cast<ptrdiff_t>(DATE_LENGTH + TIME_LENGTH + 1)
+			|| current[DATE_LENGTH] != '\t') {
+			throwTimestampFormatError();
+		}
+
+		tick.timestamp = decodeTimestamp(current, current + DATE_LENGTH + 1);
+		current += DATE_LENGTH + 1 + TIME_LENGTH;
+
+		string_view bid = nextCell(current, row_end);
+		string_view ask = nextCell(current, row_end);
+		nextCell(current, row_end); // skip column <LAST>
+		string_view volume = nextCell(current, row_end);
+		string_view flags = nextCell(current, row_end);
+
+		tick.bid = Cell(bid).toNumberOrDefault(tick.bid);
+		tick.ask = Cell(ask).toNumberOrDefault(tick.ask);
+		tick.volume = Cell(volume).toNumberOrDefault(tick.volume);
+		tick.flags = getFlags(Cell(flags));
+	}
+
+	/**
+	 * @brief Gets the next tab separated cell of a row.
+	 * @param current pointer to the delimiter preceding the cell, it is moved behind the cell.
+	 * @param row_end pointer behind the last character of the row.
+	 * @return the cell.
+	 */
+	static string_view nextCell(const char*& current, const char* row_end) {
+		if (current == row_end || *current != '\t') {
+			throw format_error("Unexpected number of columns.");
+		}
+
+		const char* cell_start = ++current;
+		while (current != row_end && *current != '\t') {
+			++current;
+		}
+
+		return string_view(cell_start, current - cell_start);
+	}
+
+	/**
+	 * @brief Decodes a fixed width decimal number.
+	 * @tparam N count of the digits.
+	 * @param digits pointer to the first digit.
+	 * @return decoded number.
+	 */
+	template <size_t N>
+	static int decodeDigits(const char* digits) {
+		int value = 0;
+		for (size_t i = 0; i < N; ++i) {
+			unsigned digit = static_cast<unsigned char>(digits[i]) - '0';
+			if (digit > 9) {
+				throwTimestampFormatError();
+			}
+
+			value = value * 10 + digit;
+		}
+
+		return value;
+	}
+
+	/**
+	 * @brief Decodes timestamp in the `YYYY.MM.DD` and `HH:MM:SS.mmm` format.
+	 * @param date pointer to the date.
+	 * @param time pointer to the time.
+	 * @return decoded time point.
+	 */
+	TimePoint decodeTimestamp(const char* date, const char* time) {
+		using namespace std::chrono;
+
+		// consecutive ticks almost always share the date, so the calendar conversion is cached
+		if (std::memcmp(date, _cached_date, DATE_LENGTH) != 0) {
+			if (date[4] != '.' || date[7] != '.') {
+				throwTimestampFormatError();
+			}
+
+			year_month_day ymd{
+				year(decodeDigits<4>(date)),
+				month(decodeDigits<2>(date + 5)),
+				day(decodeDigits<2>(date + 8)) };
+			if (!ymd.ok()) {
+				throwTimestampFormatError();
+			}
+
+			_cached_day = sys_days(ymd);
+			std::memcpy(_cached_date, date, DATE_LENGTH);
+		}
+
+		if (time[2] != ':' || time[5] != ':' || time[8] != '.') {
+			throwTimestampFormatError();
+		}
+
+		milliseconds time_of_day = hours(decodeDigits<2>(time))
+			+ minutes(decodeDigits<2>(time + 3))
+			+ seconds(decodeDigits<2>(time + 6))
+			+ milliseconds(decodeDigits<3>(time + 9));
+		return _cached_day + time_of_day;
+	}
 
 	ChangeFlag getFlags(Cell cell) const {
 		int flag_value;
@@ -106,9 +580,85 @@ private:
 		TimePoint tp;
 		iss >> std::chrono::parse(format.c_str(), tp);
 		if (iss.fail()) {
-			throw format_error("Enexpected format of timestamps - conversion failed.");
+			throwTimestampFormatError();
 		}
 
 		return tp;
 	}
 };
+
+/**
+ * @brief Tick source that streams ticks from a file in the TickParser's format with bounded memory.
+ *
+ * The file is read by blocks, complete rows of a block are parsed into a reused chunk of ticks
+ * and the incomplete last row is carried over to the next block.
+ */
+export class TickFileSource : public TickSource {
+public:
+	/**
+	 * @brief Default size of the read block in bytes.
+	 */
+	static constexpr size_t DEFAULT_BLOCK_SIZE = 4 * 1024 * 1024;
+
+	/**
+	 * @brief Opens the file with ticks.
+	 * @param path The path to the file with ticks.
+	 * @param block_size Size of the read block in bytes.
+	 * @throws CanNotOpenFileError if the file cannot be opened.
+	 */
+	TickFileSource(const std::string& path, size_t block_size = DEFAULT_BLOCK_SIZE) :
+		_ifs(path, std::ios::binary), _buffer(std::max<size_t>(block_size, 64)) {
+		if (_ifs.fail()) {
+			throw CanNotOpenFileError();
+		}
+
+		// skip the header line
+		string header;
+		getline(_ifs, header);
+	}
+
+	TicksView next() override {
+		_ticks.clear();
+		while (_ticks.empty() && !_finished) {
+			_ifs.read(_buffer.data() + _buffered, _buffer.size() - _buffered);
+			size_t available = _buffered + static_cast<size_t>(_ifs.gcount());
+			bool end_of_file = !_ifs;
+			string_view data(_buffer.data(), available);
+
+			size_t complete_rows_end = available;
+			if (!end_of_file) {
+				size_t last_newline = data.rfind('\n');
+				if (last_newline == string_view::npos) {
+					// a row longer than the buffer
+					_buffered = available;
+					_buffer.resize(_buffer.size() * 2);
+					continue;
+				}
+
+				complete_rows_end = last_newline + 1;
+			}
+
+			try {
+				bool all_parsed = _parser.parseRows(data.substr(0, complete_rows_end), _parser._intermediate_tick, _ticks);
+				_finished = !all_parsed || end_of_file;
+			}
+			catch (const std::runtime_error&) {
+				// keep the ticks preceding the malformatted row as TickParser::getTicks does
+				_finished = true;
+			}
+
+			_buffered = available - complete_rows_end;
+			std::copy(_buffer.begin() + complete_rows_end, _buffer.begin() + available, _buffer.begin());
+		}
+
+		return _ticks;
+	}
+
+private:
+	std::ifstream _ifs;
+	TickParser _parser;
+	vector<char> _buffer;
+	size_t _buffered = 0;
+	Ticks _ticks;
+	bool _finished = false;
+};
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <execution>
+#include <functional>
+
+import AlgoTrading;
+import MovingAverageRobot;
+import Backtesting;
+import TickCache;
+import DemoGrid;
+
+using namespace std;
+using namespace Backtesting;
+
+using BestPair = std::pair<TradingResults, MovingAverageRobotParameters>;
+
+/**
+ * @brief Runs the optimization and measures its duration.
+ * @param optimize the measured optimization.
+ * @param best output parameter - the best results and parameters.
+ * @return duration in milliseconds.
+ */
+double measure(std::function<BestPair()> optimize, BestPair& best) {
+	using namespace std::chrono;
+
+	auto start = steady_clock::now();
+	best = optimize();
+	auto end = steady_clock::now();
+	return duration<double, milli>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+	string path_to_csv_file;
+	if (argc > 1) {
+		path_to_csv_file = argv[1];
+	}
+	else {
+		std::cout << "Insert a path to a csv file containing ticks: ";
+		std::getline(std::cin, path_to_csv_file);
+	}
+
+	TickCache tick_cache;
+	TicksView ticks = tick_cache.load(path_to_csv_file);
+	if (ticks.empty()) {
+		std::cout << "The file is empty or we are not able to parse the ticks." << endl;
+		return -1;
+	}
+
+	StrategyTester tester(ticks, SimulationPeriod::S1, AccountProperties());
+	constexpr Timeframe used_timeframes[] = { Timeframe::MIN5 };
+	tester.precomputeBars(used_timeframes);
+
+	auto combinations = getParameterCombinations();
+	precomputeRobotIndicators(tester, combinations);
+	StrategyOptimizer<MovingAverageRobot, MovingAverageRobotParameters> optimizer(&tester, createRobot);
+	std::cout << "Demo grid: " << combinations.size() << " combinations on " << ticks.size() << " ticks." << endl;
+
+	// warm-up run, so the first measurement does not pay for cold caches
+	BestPair reference;
+	measure([&]() { return optimizer.findBestParametersSeq(combinations); }, reference);
+
+	BestPair best;
+	double par_ms = measure([&]() { return optimizer.findBestParametersParallel(combinations); }, best);
+	std::cout << "std::execution::par: " << par_ms << " ms" << endl;
+
+	std::cout << "Workers | in order ms | cost ordered ms | speedup to 1 worker | speedup to par | same best" << endl;
+	size_t max_workers = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	double one_worker_ms = 0;
+	for (size_t workers = 1; workers <= max_workers; workers = workers < max_workers ? std::min(workers * 2, max_workers) : workers + 1) {
+		ThreadPool thread_pool(workers);
+		double in_order_ms = measure([&]() { return optimizer.findBestParameters(thread_pool, combinations); }, best);
+		bool is_same = best.first.account_balance == reference.first.account_balance;
+		double ordered_ms = measure([&]() {
+			return optimizer.findBestParameters(thread_pool, combinations, estimateRobotCost);
+			}, best);
+		is_same = is_same && best.first.account_balance == reference.first.account_balance;
+		if (workers == 1) {
+			one_worker_ms = std::min(in_order_ms, ordered_ms);
+		}
+
+		double fastest_ms = std::min(in_order_ms, ordered_ms);
+		std::cout << workers << " | " << in_order_ms << " | " << ordered_ms << " | "
+			<< one_worker_ms / fastest_ms << " | " << par_ms / fastest_ms << " | " << (is_same ? "yes" : "no") << endl;
+	}
+
+	// the evolutionary search evaluates a fraction of the grid
+	ThreadPool thread_pool;
+	EvolutionSettings settings;
+	settings.max_evaluations = combinations.size() / 8;
+	double evolved_ms = measure([&]() {
+		return optimizer.findBestParametersEvolved(thread_pool, combinations, mutateRobotParameters, crossRobotParameters, finalBalance, settings);
+		}, best);
+	std::cout << "Evolution of " << settings.max_evaluations << " evaluations: " << evolved_ms << " ms, balance "
+		<< best.first.account_balance << " (grid best " << reference.first.account_balance << ")" << endl;
+
+	// the successive halving tests the combinations on growing prefixes of the ticks, about a tenth of the grid's ticks
+	double halving_ms = measure([&]() { return optimizer.findBestParametersHalving(thread_pool, combinations); }, best);
+	std::cout << "Successive halving: " << halving_ms << " ms, balance " << best.first.account_balance << endl;
+
+	// the sampled search tests a Sobol sample of the space and refines around its best points
+	SamplingSettings sampling_settings;
+	sampling_settings.max_evaluations = combinations.size() / 8;
+	double sampled_ms = measure([&]() {
+		return optimizer.findBestParametersSampled(thread_pool, getParameterSpace(), createRobotParameters, finalBalance, sampling_settings);
+		}, best);
+	std::cout << "Sampling of " << sampling_settings.max_evaluations << " evaluations: " << sampled_ms << " ms, balance "
+		<< best.first.account_balance << endl;
+
+	return 0;
+}
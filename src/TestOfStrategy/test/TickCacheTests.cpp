@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <system_error>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include "TickTestUtils.h"
+
+import AlgoTrading;
+import TickParser;
+import TickCache;
+
+/**
+ * @brief Writes a tick file for the test and removes the cache left by previous runs.
+ */
+std::string prepareTickFile(const std::string& name, size_t row_count = 400) {
+	std::string path = writeTickFile(name, row_count);
+	std::filesystem::remove(TickCache::getDefaultCachePath(path));
+	return path;
+}
+
+/**
+ * @brief Removes the tick file and its cache.
+ */
+void removeTickFile(const std::string& path) {
+	std::filesystem::remove(TickCache::getDefaultCachePath(path));
+	std::filesystem::remove(path);
+}
+
+std::string readFile(const std::string& path) {
+	std::ifstream ifs(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Overwrites bytes of the file at the given offset, the size of the file is kept.
+ */
+void overwriteFile(const std::string& path, size_t offset, std::string_view bytes) {
+	std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+	fs.seekp(offset);
+	fs.write(bytes.data(), bytes.size());
+}
+
+TEST(TickCacheTests, ColdLoadWritesCache) {
+	std::string path = prepareTickFile("TickCacheTests_ColdLoadWritesCache.csv");
+	{
+		TickCache tick_cache;
+		TicksView ticks = tick_cache.load(path);
+		EXPECT_FALSE(tick_cache.wasLoadedFromCache());
+		EXPECT_TRUE(std::filesystem::exists(TickCache::getDefaultCachePath(path)));
+		expectSameTicks(TickParser().getTicks(path), ticks);
+	}
+
+	removeTickFile(path);
+}
+
+TEST(TickCacheTests, WarmLoadReturnsSameTicks) {
+	std::string path = prepareTickFile("TickCacheTests_WarmLoadReturnsSameTicks.csv");
+	Ticks expected = TickParser().getTicks(path);
+	ASSERT_EQ(expected.size(), 400);
+	TickCache().load(path);
+	{
+		TickCache tick_cache;
+		TicksView ticks = tick_cache.load(path);
+		EXPECT_TRUE(tick_cache.wasLoadedFromCache());
+		expectSameTicks(expected, ticks);
+	}
+
+	removeTickFile(path);
+}
+
+TEST(TickCacheTests, ChangedSizeRebuildsCache) {
+	std::string path = prepareTickFile("TickCacheTests_ChangedSizeRebuildsCache.csv");
+	TickCache().load(path);
+	writeTickFile("TickCacheTests_ChangedSizeRebuildsCache.csv", 500);
+	{
+		TickCache tick_cache;
+		TicksView ticks = tick_cache.load(path);
+		EXPECT_FALSE(tick_cache.wasLoadedFromCache());
+		ASSERT_EQ(ticks.size(), 500);
+		expectSameTicks(TickParser().getTicks(path), ticks);
+	}
+
+	{
+		TickCache tick_cache;
+		EXPECT_EQ(tick_cache.load(path).size(), 500);
+		EXPECT_TRUE(tick_cache.wasLoadedFromCache());
+	}
+
+	removeTickFile(path);
+}
+
+TEST(TickCacheTests, TouchedSourceIsServedFromCacheAndRestamped) {
+	std::string path = prepareTickFile("TickCacheTests_TouchedSourceIsServedFromCacheAndRestamped.csv");
+	std::string cache_path = TickCache::getDefaultCachePath(path);
+	TickCache().load(path);
+	std::string untouched_cache = readFile(cache_path);
+	std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::hours(1));
+	{
+		TickCache tick_cache;
+		TicksView ticks = tick_cache.load(path);
+		EXPECT_TRUE(tick_cache.wasLoadedFromCache());
+		expectSameTicks(TickParser().getTicks(path), ticks);
+	}
+
+	// the refreshed cache equals the cache written for the touched file, so the next loads do not hash the file
+	std::string refreshed_cache = readFile(cache_path);
+	EXPECT_NE(refreshed_cache, untouched_cache);
+	std::filesystem::remove(cache_path);
+	TickCache().load(path);
+	EXPECT_EQ(readFile(cache_path), refreshed_cache);
+
+	removeTickFile(path);
+}
+
+TEST(TickCacheTests, ChangedContentOfSameSizeRebuildsCache) {
+	std::string path = prepareTickFile("TickCacheTests_ChangedContentOfSameSizeRebuildsCache.csv");
+	TickCache().load(path);
+	auto modification_time = std::filesystem::last_write_time(path);
+	std::string content = readFile(path);
+	size_t first_bid_position = content.find("0.86", content.find('\n'));
+	ASSERT_NE(first_bid_position, std::string::npos);
+
+	// the time is set explicitly, so the change is visible to the metadata even with a coarse file clock
+	overwriteFile(path, first_bid_position, "0.87");
+	std::filesystem::last_write_time(path, modification_time + std::chrono::seconds(1));
+	{
+		TickCache tick_cache;
+		TicksView ticks = tick_cache.load(path);
+		EXPECT_FALSE(tick_cache.wasLoadedFromCache());
+		ASSERT_FALSE(ticks.empty());
+		EXPECT_DOUBLE_EQ(ticks.front().bid, 0.87);
+		expectSameTicks(TickParser().getTicks(path), ticks);
+	}
+
+	// the content validation detects the change even if the time is kept
+	overwriteFile(path, first_bid_position, "0.88");
+	std::filesystem::last_write_time(path, modification_time + std::chrono::seconds(1));
+	{
+		TickCache tick_cache(CacheValidation::CONTENT);
+		TicksView ticks = tick_cache.load(path);
+		EXPECT_FALSE(tick_cache.wasLoadedFromCache());
+		expectSameTicks(TickParser().getTicks(path), ticks);
+	}
+
+	removeTickFile(path);
+}
+
+TEST(TickCacheTests, ForeignFormatRebuildsCache) {
+	std::string path = prepareTickFile("TickCacheTests_ForeignFormatRebuildsCache.csv");
+	std::string cache_path = TickCache::getDefaultCachePath(path);
+	Ticks expected = TickParser().getTicks(path);
+
+	// the header starts with the magic followed by the version of the format
+	uint32_t next_version = TickCache::FORMAT_VERSION + 1;
+	std::string_view version_bytes(reinterpret_cast<const char*>(&next_version), sizeof(next_version));
+	for (auto [offset, bytes] : { std::pair<size_t, std::string_view>(0, "XX"), std::pair<size_t, std::string_view>(8, version_bytes) }) {
+		TickCache().load(path);
+		overwriteFile(cache_path, offset, bytes);
+
+		TickCache tick_cache;
+		TicksView ticks = tick_cache.load(path);
+		EXPECT_FALSE(tick_cache.wasLoadedFromCache());
+		expectSameTicks(expected, ticks);
+	}
+
+	{
+		TickCache tick_cache;
+		tick_cache.load(path);
+		EXPECT_TRUE(tick_cache.wasLoadedFromCache());
+	}
+
+	removeTickFile(path);
+}
+
+TEST(TickCacheTests, TruncatedCacheIsRebuilt) {
+	std::string path = prepareTickFile("TickCacheTests_TruncatedCacheIsRebuilt.csv");
+	std::string cache_path = TickCache::getDefaultCachePath(path);
+	Ticks expected = TickParser().getTicks(path);
+	TickCache().load(path);
+	const auto cache_size = std::filesystem::file_size(cache_path);
+
+	// the cache is cut in the last tick and in the header
+	for (auto truncated_size : { cache_size - 5, decltype(cache_size)(20) }) {
+		std::filesystem::resize_file(cache_path, truncated_size);
+
+		TickCache tick_cache;
+		TicksView ticks = tick_cache.load(path);
+		EXPECT_FALSE(tick_cache.wasLoadedFromCache());
+		expectSameTicks(expected, ticks);
+		EXPECT_EQ(std::filesystem::file_size(cache_path), cache_size);
+	}
+
+	removeTickFile(path);
+}
+
+TEST(TickCacheTests, ReadOnlyLocationFallsBackToParsing) {
+	std::string path = prepareTickFile("TickCacheTests_ReadOnlyLocationFallsBackToParsing.csv");
+
+	// nothing can be created below a regular file, not even by a privileged user that ignores permissions
+	std::string cache_path = path + "/ticks.cache";
+	{
+		TickCache tick_cache;
+		TicksView ticks = tick_cache.load(path, cache_path);
+		EXPECT_FALSE(tick_cache.wasLoadedFromCache());
+		expectSameTicks(TickParser().getTicks(path), ticks);
+	}
+
+	std::error_code ec;
+	EXPECT_FALSE(std::filesystem::exists(cache_path, ec));
+	removeTickFile(path);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <filesystem>
+#include "TickTestUtils.h"
+
+import AlgoTrading;
+import TickParser;
+
+TEST(TickFileSourceTests, MatchesGetTicks) {
+	std::string path = writeTickFile("TickFileSourceTests_MatchesGetTicks.csv", 400);
+	Ticks expected = TickParser().getTicks(path);
+	ASSERT_EQ(expected.size(), 400);
+
+	// tiny blocks split rows and start with empty cells, the longest rows need several doublings of the block
+	for (size_t block_size : { size_t(1), size_t(64), size_t(100), size_t(1000), TickFileSource::DEFAULT_BLOCK_SIZE }) {
+		TickFileSource tick_source(path, block_size);
+		Ticks ticks;
+		for (TicksView chunk = tick_source.next(); !chunk.empty(); chunk = tick_source.next()) {
+			ticks.insert(ticks.end(), chunk.begin(), chunk.end());
+		}
+
+		expectSameTicks(expected, ticks);
+		EXPECT_TRUE(tick_source.next().empty());
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST(TickParserTests, FastParsingMatchesGetTicks) {
+	std::string path = writeTickFile("TickParserTests_FastParsingMatchesGetTicks.csv", 400);
+	Ticks expected = TickParser().getTicks(path);
+	ASSERT_EQ(expected.size(), 400);
+
+	expectSameTicks(expected, TickParser().getTicksFast(path));
+
+	std::filesystem::remove(path);
+}
+
+TEST(TickParserTests, ParallelParsingMatchesGetTicks) {
+	std::string path = writeTickFile("TickParserTests_ParallelParsingMatchesGetTicks.csv", 400);
+	Ticks expected = TickParser().getTicks(path);
+	ASSERT_EQ(expected.size(), 400);
+
+	// small chunks put empty cells at the chunk seams and leave the volume unset in whole chunks
+	for (size_t min_chunk_size : { size_t(64), size_t(1000), size_t(4000) }) {
+		TickParser tick_parser;
+		expectSameTicks(expected, tick_parser.getTicksParallel(path, min_chunk_size));
+		EXPECT_GT(tick_parser.getLastLoadTimings().chunk_count, 1);
+	}
+
+	std::filesystem::remove(path);
+}
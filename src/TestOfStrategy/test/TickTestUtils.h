@@ -0,0 +1,55 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+
+import AlgoTrading;
+
+/**
+ * @brief Writes a tick file with the given count of rows into the temporary directory.
+ * @note Some bid and ask cells and most of the volume cells are empty, so their values are carried forward from the previous rows,
+ * and the <LAST> cells of some rows are long, so the rows do not fit small read blocks.
+ */
+inline std::string writeTickFile(const std::string& name, size_t row_count) {
+	auto path = (std::filesystem::temp_directory_path() / name).string();
+	std::ofstream ofs(path, std::ios::binary);
+	ofs << "<DATE>\t<TIME>\t<BID>\t<ASK>\t<LAST>\t<VOLUME>\t<FLAGS>\n";
+	for (size_t i = 0; i < row_count; ++i) {
+		size_t ms = i * 137;
+		char time[16];
+		std::snprintf(time, sizeof(time), "15:%02zu:%02zu.%03zu", ms / 60000 % 60, ms / 1000 % 60, ms % 1000);
+		double bid = 0.86 + (i * 7919 % 101) * 0.00001;
+		char bid_cell[16] = "";
+		char ask_cell[16] = "";
+		if (i % 3 != 1) {
+			std::snprintf(bid_cell, sizeof(bid_cell), "%.5f", bid);
+		}
+
+		if (i % 5 != 2) {
+			std::snprintf(ask_cell, sizeof(ask_cell), "%.5f", bid + 0.0003);
+		}
+
+		std::string last = i % 17 == 0 ? std::string(i * 3, '1') : std::string();
+		std::string volume = i % 150 == 0 ? std::to_string(i % 7 + 1) : std::string();
+		ofs << "2022.11.10\t" << time << '\t' << bid_cell << '\t' << ask_cell << '\t' << last << '\t' << volume << "\t6\n";
+	}
+
+	return path;
+}
+
+/**
+ * @brief Expects both sequences of ticks to be equal.
+ */
+inline void expectSameTicks(TicksView expected, TicksView actual) {
+	ASSERT_EQ(expected.size(), actual.size());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		EXPECT_EQ(expected[i].timestamp, actual[i].timestamp);
+		EXPECT_EQ(expected[i].bid, actual[i].bid);
+		EXPECT_EQ(expected[i].ask, actual[i].ask);
+		EXPECT_EQ(expected[i].volume, actual[i].volume);
+		EXPECT_EQ(expected[i].flags, actual[i].flags);
+	}
+}
@@ -4,12 +4,14 @@
 #include <chrono>
 #include <string>
 #include <functional>
+#include <execution>
 
 import AlgoTrading;
 import Utils;
 import MovingAverageRobot;
 import Backtesting;
-import TickParser;
+import TickCache;
+import DemoGrid;
 
 using namespace std;
 using namespace utils;
@@ -67,52 +69,6 @@ void printResults(const TradingResults& results) {
 	//std::cout << "Final total equity (includes open positions): " << results.total_equity << endl;
 }
 
-/**
- * @brief Structure for storing parameters of the MovingAverageRobot.
- */
-struct MovingAverageRobotParameters {
-	size_t fast_MA_period;
-	size_t slow_MA_period;
-	float allowed_loss_on_trade;
-	float risk_reward_ratio;
-};
-
-/**
- * @brief Generates combinations of parameters for the MovingAverageRobot.
- * @return Vector of parameter combinations.
- */
-std::vector<MovingAverageRobotParameters> getParameterCombinations() {
-	std::vector<MovingAverageRobotParameters> parameter_combinations;
-	for (size_t fast_MA_period = 5; fast_MA_period < 12; fast_MA_period++) {
-		for (size_t slow_MA_period = 12; slow_MA_period < 40; slow_MA_period++) {
-			for (float allowed_loss_on_trade = 0.005; allowed_loss_on_trade < 0.025; allowed_loss_on_trade += 0.005) {
-				for (float risk_reward_ratio = 1; risk_reward_ratio < 2; risk_reward_ratio += 0.2) {
-					parameter_combinations.emplace_back(
-						fast_MA_period,
-						slow_MA_period,
-						allowed_loss_on_trade,
-						risk_reward_ratio);
-				}
-			}
-		}
-	}
-
-	return parameter_combinations;
-}
-
-/**
- * @brief Creates a MovingAverageRobot with given parameters.
- * @param params Parameters for the robot.
- * @return Created robot.
- */
-MovingAverageRobot createRobot(MovingAverageRobotParameters params) {
-	return MovingAverageRobot(
-		params.fast_MA_period,
-		params.slow_MA_period,
-		params.allowed_loss_on_trade,
-		params.risk_reward_ratio);
-}
-
 /**
  * @brief Measures the time of execution of a function.
  * @tparam ReturnType Type of the return value of the function.
@@ -136,18 +92,18 @@ size_t measure(std::function<ReturnType()> func, ReturnType& result) {
 int main(int argc, char* argv[]) {
 	// first we need load and parse the ticks
 	std::cout << "Parsing ticks (advised to run with release configuration)." << endl;
-	TickParser tick_parser; // custom helper class for parsing the specific csv format.
-	Ticks ticks;
+	TickCache tick_cache; // parses the specific csv format once and memory maps its binary cache on later runs.
+	TicksView ticks;
 	string path_to_csv_file;
 
 	// for loading ticks we need a path to the file containing them in csv format
 	std::cout << "Insert a path to a csv file containing ticks: ";
 	std::getline(std::cin, path_to_csv_file);
 
-	// load and parse the ticks using tick_parser
-	auto parsing_duration = measure<Ticks>(
+	// load the ticks using tick_cache
+	auto parsing_duration = measure<TicksView>(
 		[&]() {
-		return tick_parser.getTicks(path_to_csv_file);
+		return tick_cache.load(path_to_csv_file);
 		}, 
 		ticks);
 	
@@ -159,10 +115,19 @@ int main(int argc, char* argv[]) {
 
 	// print information about the tick parsing
 	std::cout << "Number of ticks: " << ticks.size() << \
-		" loaded and parsed in " << parsing_duration << " milliseconds" << endl;
+		(tick_cache.wasLoadedFromCache() ? " loaded from cache in " : " loaded and parsed in ") << \
+		parsing_duration << " milliseconds" << endl;
 
 	// Create a strategy tester
-	StrategyTester tester(&ticks, SimulationPeriod::S1, AccountProperties());
+	StrategyTester tester(ticks, SimulationPeriod::S1, AccountProperties());
+
+	// calculate the bars used by MovingAverageRobot on all cores before the robots are simulated
+	constexpr Timeframe used_timeframes[] = { Timeframe::MIN5 };
+	auto precomputing_start = std::chrono::high_resolution_clock::now();
+	tester.precomputeBars(used_timeframes);
+	auto precomputing_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::high_resolution_clock::now() - precomputing_start);
+	std::cout << "Precomputing of bars took " << precomputing_duration.count() << " milliseconds" << endl;
 
 	// measure running of one robot
 	std::cout << "Simulating of one robot took ";
@@ -178,6 +143,9 @@ int main(int argc, char* argv[]) {
 
 	// get combinations of parameters
 	auto comb = getParameterCombinations();
+
+	// calculate the indicators of all the combinations, so the robots only look their values up
+	precomputeRobotIndicators(tester, comb);
 	
 	// initialize the StrategyOptimizer with pointer to configured StrategyTester and robot factory method
 	StrategyOptimizer<MovingAverageRobot, MovingAverageRobotParameters> optimizer(&tester, createRobot);
@@ -194,6 +162,32 @@ int main(int argc, char* argv[]) {
 		[&]() { return optimizer.findBestParametersSeq(comb); }, best_pair);
 	std::cout << seq_sim_duration << " milliseconds in sequential." << endl;
 
+	// measure the parallel testing of batches of robots going through the ticks together
+	auto batched_sim_duration = measure<std::pair<TradingResults, MovingAverageRobotParameters>>(
+		[&]() { return optimizer.findBestParametersBatched(std::execution::par, comb); }, best_pair);
+	std::cout << "Simulating in batches of robots took " << batched_sim_duration << " milliseconds in parallel." << endl;
+
+	// measure the parallel testing comparing only summaries of the trading, the winner is run again for its trades
+	auto summarized_sim_duration = measure<std::pair<TradingResults, MovingAverageRobotParameters>>(
+		[&]() { return optimizer.findBestParametersSummarized(std::execution::par, comb); }, best_pair);
+	std::cout << "Simulating with summaries only took " << summarized_sim_duration << " milliseconds in parallel." << endl;
+
+	// walk-forward: optimize on 4 rolling in-sample windows and validate every winner on the following 1/8 of the ticks
+	ThreadPool thread_pool;
+	WalkForwardSettings walk_forward_settings(ticks.size() / 2, ticks.size() / 8);
+	auto walk_forward_start = std::chrono::high_resolution_clock::now();
+	auto walk_forward = optimizer.walkForward(thread_pool, comb, walk_forward_settings);
+	auto walk_forward_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::high_resolution_clock::now() - walk_forward_start);
+	std::cout << "Walk-forward of " << walk_forward.windows.size() << " windows took " << walk_forward_duration.count()
+		<< " milliseconds, out-of-sample balance: " << walk_forward.summary.account_balance << endl;
+
+	// resample the trades of the best parameters to see how much the result depends on their order
+	MonteCarloResults monte_carlo = MonteCarloAnalyzer(best_pair.first).run(thread_pool);
+	std::cout << "Monte Carlo of " << monte_carlo.path_count << " resampled trade sequences: 5-95% final balance "
+		<< monte_carlo.final_balance.percentile_5 << " - " << monte_carlo.final_balance.percentile_95
+		<< ", 95% max drawdown " << monte_carlo.max_drawdown.percentile_95 << endl;
+
 	// calculate speedup
 	float speedup = static_cast<float>(seq_sim_duration) / parallel_sim_duration;
 	std::cout << "Which means we have achieved " << speedup << " speedup factor." << endl;
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+#include <functional>
+
+import AlgoTrading;
+import TickParser;
+
+using namespace std;
+
+/**
+ * @brief Results of repeated runs of one parser.
+ */
+struct BenchmarkResult {
+	double best_ms;
+	double mean_ms;
+	Ticks ticks;
+};
+
+/**
+ * @brief Runs the given parsing function repeatedly and measures it.
+ * @param parse Parsing function to measure.
+ * @param repetitions How many times to run the function.
+ * @return best and mean duration and the ticks of the last run.
+ */
+BenchmarkResult runBenchmark(std::function<Ticks()> parse, size_t repetitions) {
+	using namespace std::chrono;
+
+	BenchmarkResult result{ 0, 0, {} };
+	double total_ms = 0;
+	for (size_t i = 0; i < repetitions; ++i) {
+		auto start = high_resolution_clock::now();
+		result.ticks = parse();
+		auto end = high_resolution_clock::now();
+
+		double duration_ms = duration<double, milli>(end - start).count();
+		total_ms += duration_ms;
+		result.best_ms = i == 0 ? duration_ms : std::min(result.best_ms, duration_ms);
+	}
+
+	result.mean_ms = total_ms / repetitions;
+	return result;
+}
+
+/**
+ * @brief Prints the measured throughput of one parser.
+ * @param name Name of the parser.
+ * @param result Measured results.
+ * @param file_size Size of the parsed file in bytes.
+ */
+void printResult(const string& name, const BenchmarkResult& result, uintmax_t file_size) {
+	double ticks_per_second = result.ticks.size() / (result.best_ms / 1000);
+	double megabytes_per_second = (file_size / (1024.0 * 1024.0)) / (result.best_ms / 1000);
+	std::cout << name << ": best " << result.best_ms << " ms, mean " << result.mean_ms << " ms, "
+		<< ticks_per_second / 1e6 << " M ticks/s, " << megabytes_per_second << " MB/s" << endl;
+}
+
+/**
+ * @brief Compares ticks produced by both parsers.
+ * @param expected Ticks of the reference parser.
+ * @param actual Ticks of the measured parser.
+ */
+void compareTicks(const Ticks& expected, const Ticks& actual) {
+	using namespace std::chrono;
+
+	if (expected.size() != actual.size()) {
+		std::cout << "Tick counts differ: " << expected.size() << " vs " << actual.size() << endl;
+		return;
+	}
+
+	size_t value_mismatches = 0;
+	size_t subsecond_mismatches = 0;
+	for (size_t i = 0; i < expected.size(); ++i) {
+		const Tick& e = expected[i];
+		const Tick& a = actual[i];
+		if (e.bid != a.bid || e.ask != a.ask || e.volume != a.volume || e.flags != a.flags
+			|| floor<seconds>(e.timestamp) != floor<seconds>(a.timestamp)) {
+			++value_mismatches;
+		}
+		else if (e.timestamp != a.timestamp) {
+			++subsecond_mismatches;
+		}
+	}
+
+	std::cout << "Mismatching ticks: " << value_mismatches
+		<< ", ticks differing only in sub-second part of timestamp: " << subsecond_mismatches << endl;
+}
+
+int main(int argc, char* argv[]) {
+	string path_to_csv_file;
+	if (argc > 1) {
+		path_to_csv_file = argv[1];
+	}
+	else {
+		std::cout << "Insert a path to a csv file containing ticks (e.g. tests/data/AUDCAD_*.csv): ";
+		std::getline(std::cin, path_to_csv_file);
+	}
+
+	size_t repetitions = argc > 2 ? std::stoul(argv[2]) : 5;
+
+	std::error_code ec;
+	uintmax_t file_size = std::filesystem::file_size(path_to_csv_file, ec);
+	if (ec) {
+		std::cout << "Cannot read the provided file." << endl;
+		return -1;
+	}
+
+	// a fresh parser for every run, so the carried-forward state does not leak between runs;
+	// the baseline is the single-threaded path, getTicks loads large files in parallel
+	auto current = runBenchmark([&]() { return TickParser().getTicksSequential(path_to_csv_file); }, repetitions);
+	auto fast = runBenchmark([&]() { return TickParser().getTicksFast(path_to_csv_file); }, repetitions);
+	TickParser parallel_parser;
+	auto parallel = runBenchmark([&]() {
+		parallel_parser = TickParser();
+		return parallel_parser.getTicksParallel(path_to_csv_file);
+		}, repetitions);
+	if (current.ticks.empty()) {
+		std::cout << "The file is empty or we are not able to parse the ticks." << endl;
+		return -1;
+	}
+
+	std::cout << "Parsed " << current.ticks.size() << " ticks (" << file_size << " bytes), "
+		<< repetitions << " repetitions." << endl;
+	printResult("TickParser::getTicksSequential", current, file_size);
+	printResult("TickParser::getTicksFast      ", fast, file_size);
+	printResult("TickParser::getTicksParallel  ", parallel, file_size);
+	std::cout << "Speedup of the fast path: " << current.best_ms / fast.best_ms
+		<< ", of the parallel path: " << current.best_ms / parallel.best_ms << endl;
+
+	const TickLoadTimings& timings = parallel_parser.getLastLoadTimings();
+	std::cout << "Phases of the last parallel load (" << timings.chunk_count << " chunks): splitting "
+		<< timings.splitting_ms << " ms, parsing " << timings.parsing_ms << " ms, stitching "
+		<< timings.stitching_ms << " ms, total " << timings.total_ms << " ms" << endl;
+
+	compareTicks(current.ticks, fast.ticks);
+	compareTicks(current.ticks, parallel.ticks);
+
+	return 0;
+}
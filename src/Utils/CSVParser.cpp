@@ -10,9 +10,12 @@ module;
 #include <optional>
 #include <utility>
 #include <stdexcept>
+#include <algorithm>
 
 export module Utils : CSVParser;
 
+import : MemoryMappedFile;
+
 using namespace std;
 export namespace utils {
 
@@ -37,6 +40,7 @@ public:
 
 class CellStream;
 class Row;
+class RowStream;
 class CSVParser;
 
 
@@ -47,15 +51,26 @@ class CSVParser {
 	friend class RowStream;
 
 public:
+	/**
+	 * @brief Specifies how the file is read.
+	 */
+	enum ReadMode {
+		// rows are read line by line from an input stream into a buffer
+		STREAM,
+		// the file is memory mapped and rows and cells are views into the mapping - no allocation per row
+		MEMORY_MAPPED
+	};
+
 	/**
 	* @brief Initializes the CSVParser with the specified path, column count, delimiter and whether to skip the first line.
 	* @param path The path to the file to parse.
 	* @param column_count The number of columns in the file.
 	* @param delimiter The delimiter used in the file.
 	* @param skip_first_line Whether to skip the first line.
+	* @param read_mode Whether to read the file as a stream or to memory map it.
 	* @throws CanNotOpenFileError if the file cannot be opened.
 	*/
-	CSVParser(const std::string& path, unsigned int column_count, char delimiter, bool skip_first_line = true);
+	CSVParser(const std::string& path, unsigned int column_count, char delimiter, bool skip_first_line = true, ReadMode read_mode = STREAM);
 
 	/**
 	 * @brief Initializes the CSVParser with the specified input stream, column count, delimiter and whether to skip the first line.
@@ -81,55 +96,59 @@ public:
 
 private:
 	std::ifstream _ifs;
-	std::istream* _is_ptr;
+	std::istream* _is_ptr = nullptr;
 	unsigned int _column_count;
 	char _delimiter;
+	ReadMode _read_mode = STREAM;
+	MemoryMappedFile _mapping;
+	size_t _mapped_position = 0;
 };
 
+/**
+ * @brief Represents a row of a CSV file - a view of the line, cells are split on demand.
+ * @note The row is valid until the next row is read from the stream (or until the parser is destroyed
+ * in the memory mapped mode).
+ */
 class Row {
 	friend class CellStream;
 public:
-	Row() : _current_column_count(0), _splitted_row() {}
+	Row() = default;
 
-	using SplittedRow = ranges::split_view<ranges::ref_view<string>, ranges::single_view<char>>;
-	Row(SplittedRow splitted_row) :
-		_splitted_row(splitted_row) {
-		_current_column_count = ranges::distance(splitted_row);
-		_splitted_row;
-	}
+	Row(string_view line, char delimiter) :
+		_line(line), _delimiter(delimiter) {}
 
-	void printRow() {
-		for (auto&& cell : _splitted_row.value()) {
-			std::cout << string_view(cell.begin(), cell.end()) << " delim ";
-		}
-		std::cout << std::endl;
-	}
+	void printRow();
+
+	string toString(char delimiter = ' ');
 
-	string toString(char delimiter = ' ') {
-		string result = "";
-		bool first = true;
-		for (auto&& cell : _splitted_row.value()) {
-			if (!first) {
-				result += delimiter;
-			}
-			else {
-				first = false;
-			}
-			result += string_view(cell.begin(), cell.end());
+	/**
+	 * @brief Gets the count of columns, it is counted on the first call.
+	 * @return count of columns of the row.
+	 */
+	size_t getColumnCount() {
+		if (_column_count == UNKNOWN_COLUMN_COUNT) {
+			_column_count = _line.empty() ? 0 : ranges::count(_line, _delimiter) + 1;
 		}
 
-		return result;
+		return _column_count;
 	}
 
-	size_t getColumnCount() {
-		return _current_column_count;
+	/**
+	 * @brief Gets the whole row.
+	 * @return view of the row.
+	 */
+	string_view toView() const {
+		return _line;
 	}
 
 	CellStream getCellStream();
 
 private:
-	std::optional<ranges::split_view<ranges::ref_view<string>, ranges::single_view<char>>> _splitted_row;
-	int _current_column_count;
+	static constexpr size_t UNKNOWN_COLUMN_COUNT = static_cast<size_t>(-1);
+
+	string_view _line;
+	char _delimiter = ',';
+	size_t _column_count = UNKNOWN_COLUMN_COUNT;
 };
 
 template <typename T> concept arithmetic = std::is_arithmetic_v<T>;
@@ -193,11 +212,8 @@ private:
 
 class CellStream {
 public:
-	CellStream(Row* row): _row(row) {
-		auto&& splitted_row = _row->_splitted_row.value();
-		_start_it = splitted_row.begin();
-		_end_it = splitted_row.end();
-	}
+	CellStream(Row* row) :
+		_remaining(row->_line), _delimiter(row->_delimiter), _has_next(!row->_line.empty()) {}
 
 	/**
 	 * @brief gets the next Cell.
@@ -209,8 +225,15 @@ public:
 			throw EndOfStreamException();
 		}
 
-		auto&& cell_range = *_start_it++;
-		return Cell(string_view(cell_range.begin(), cell_range.end()));
+		size_t delimiter_position = _remaining.find(_delimiter);
+		if (delimiter_position == string_view::npos) {
+			_has_next = false;
+			return Cell(_remaining);
+		}
+
+		Cell cell(_remaining.substr(0, delimiter_position));
+		_remaining.remove_prefix(delimiter_position + 1);
+		return cell;
 	}
 
 	CellStream& operator>>(Cell& cell) {
@@ -220,17 +243,16 @@ public:
 
 
 	bool good() const {
-		return _start_it != _end_it;
+		return _has_next;
 	}
 
 	operator bool() const {
 		return good();
 	}
 private:
-	size_t _index = 0;
-	Row* _row;
-	decltype(declval<Row::SplittedRow>().begin()) _start_it;
-	decltype(declval<Row::SplittedRow>().end()) _end_it;
+	string_view _remaining;
+	char _delimiter;
+	bool _has_next;
 };
 
 class RowStream {
@@ -239,25 +261,79 @@ public:
 
 	//template<typename T>
 	RowStream& operator>>(Row& row) {
+		if (_parser->_read_mode == CSVParser::MEMORY_MAPPED) {
+			row = Row(nextMappedLine(), _parser->_delimiter);
+			return *this;
+		}
+
 		getline(*(_parser->_is_ptr), _current_line);
+		// rows ended by CRLF are read without the '\r' as in the memory mapped mode
+		if (!_current_line.empty() && _current_line.back() == '\r') {
+			_current_line.pop_back();
+		}
 
-		auto split = ranges::views::split(_current_line, _parser->_delimiter);
-		row = Row(split);
+		row = Row(_current_line, _parser->_delimiter);
 		return *this;
 	}
 
 	operator bool() const {
-		return _parser->_is_ptr->good() && _parser->_is_ptr->peek() != '\n'; // True if there are more lines to process
+		if (_parser->_read_mode == CSVParser::MEMORY_MAPPED) {
+			// True if there are more lines to process
+			const size_t position = _parser->_mapped_position;
+			const string_view data = _parser->_mapping.view();
+			return position < data.size() && data[position] != '\n' && data[position] != '\r';
+		}
+
+		// True if there are more lines to process, the end of the stream after the last newline is not a line
+		const int next_char = _parser->_is_ptr->peek();
+		return next_char != istream::traits_type::eof() && next_char != '\n' && next_char != '\r';
 	}
 
 private:
 	CSVParser* _parser;
 	string _current_line;
+
+	string_view nextMappedLine() {
+		const string_view data = _parser->_mapping.view();
+		size_t& position = _parser->_mapped_position;
+		if (position >= data.size()) {
+			throw EndOfStreamException();
+		}
+
+		size_t line_end = data.find('\n', position);
+		if (line_end == string_view::npos) {
+			line_end = data.size();
+		}
+
+		string_view line = data.substr(position, line_end - position);
+		if (!line.empty() && line.back() == '\r') {
+			line.remove_suffix(1);
+		}
+
+		position = std::min(line_end + 1, data.size());
+		return line;
+	}
 };
 
 
-CSVParser::CSVParser(const std::string& path, unsigned int column_count, char delimiter, bool skip_first_line) :
-	_column_count(column_count), _delimiter(delimiter) {
+CSVParser::CSVParser(const std::string& path, unsigned int column_count, char delimiter, bool skip_first_line, ReadMode read_mode) :
+	_column_count(column_count), _delimiter(delimiter), _read_mode(read_mode) {
+	if (_read_mode == MEMORY_MAPPED) {
+		try {
+			_mapping = MemoryMappedFile(path);
+		}
+		catch (const CanNotMapFileError&) {
+			throw CanNotOpenFileError();
+		}
+
+		if (skip_first_line) {
+			size_t first_line_end = _mapping.view().find('\n');
+			_mapped_position = first_line_end == string_view::npos ? _mapping.size() : first_line_end + 1;
+		}
+
+		return;
+	}
+
 	_is_ptr = &_ifs;
 	_ifs.open(path);
 	if (_ifs.fail()) {
@@ -278,4 +354,29 @@ CellStream Row::getCellStream() {
 	return CellStream(this);
 }
 
+void Row::printRow() {
+	CellStream cell_stream = getCellStream();
+	while (cell_stream) {
+		std::cout << cell_stream.next().toView() << " delim ";
+	}
+	std::cout << std::endl;
+}
+
+string Row::toString(char delimiter) {
+	string result = "";
+	bool first = true;
+	CellStream cell_stream = getCellStream();
+	while (cell_stream) {
+		if (!first) {
+			result += delimiter;
+		}
+		else {
+			first = false;
+		}
+		result += cell_stream.next().toView();
+	}
+
+	return result;
+}
+
 }
\ No newline at end of file
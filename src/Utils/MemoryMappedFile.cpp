@@ -0,0 +1,221 @@
+module;
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <utility>
+#include <cstddef>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+export module Utils : MemoryMappedFile;
+
+using namespace std;
+export namespace utils {
+
+/**
+ * @brief Represents an exception that is thrown when a file cannot be mapped into memory.
+ */
+class CanNotMapFileError : public std::runtime_error {
+public:
+	CanNotMapFileError() :
+		std::runtime_error("Cannot map the provided file into memory.") {}
+};
+
+/**
+ * @brief Read-only view of a whole file mapped into the address space of the process.
+ * @note The mapping is released in the destructor, views obtained from it must not outlive the object.
+ */
+class MemoryMappedFile {
+public:
+	/**
+	 * @brief Creates an empty mapping.
+	 */
+	MemoryMappedFile() noexcept = default;
+
+	/**
+	 * @brief Maps the file on the given path for reading.
+	 * @param path The path to the file to map.
+	 * @throws CanNotMapFileError if the file cannot be opened or mapped.
+	 */
+	explicit MemoryMappedFile(const std::string& path);
+
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+	MemoryMappedFile(MemoryMappedFile&& other) noexcept {
+		swap(other);
+	}
+
+	MemoryMappedFile& operator=(MemoryMappedFile&& other) noexcept {
+		if (this != &other) {
+			MemoryMappedFile released(std::move(other));
+			swap(released);
+		}
+
+		return *this;
+	}
+
+	~MemoryMappedFile() {
+		unmap();
+	}
+
+	/**
+	 * @brief Gets pointer to the first byte of the mapping.
+	 * @return pointer to the mapped data or nullptr for an empty file.
+	 */
+	const char* data() const noexcept {
+		return _data;
+	}
+
+	/**
+	 * @brief Gets size of the mapped file in bytes.
+	 * @return size of the mapping.
+	 */
+	size_t size() const noexcept {
+		return _size;
+	}
+
+	/**
+	 * @brief Gets the whole mapping as a string view.
+	 * @return view of the mapped bytes.
+	 */
+	string_view view() const noexcept {
+		return string_view(_data, _size);
+	}
+
+	bool empty() const noexcept {
+		return _size == 0;
+	}
+
+private:
+	const char* _data = nullptr;
+	size_t _size = 0;
+#ifdef _WIN32
+	HANDLE _file = INVALID_HANDLE_VALUE;
+	HANDLE _mapping = nullptr;
+#endif
+
+	void swap(MemoryMappedFile& other) noexcept {
+		std::swap(_data, other._data);
+		std::swap(_size, other._size);
+#ifdef _WIN32
+		std::swap(_file, other._file);
+		std::swap(_mapping, other._mapping);
+#endif
+	}
+
+	void unmap() noexcept;
+};
+
+#ifdef _WIN32
+
+MemoryMappedFile::MemoryMappedFile(const std::string& path) {
+	_file = CreateFileA(
+		path.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		nullptr);
+	if (_file == INVALID_HANDLE_VALUE) {
+		throw CanNotMapFileError();
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(_file, &file_size)) {
+		unmap();
+		throw CanNotMapFileError();
+	}
+
+	_size = static_cast<size_t>(file_size.QuadPart);
+	if (_size == 0) {
+		// empty files cannot be mapped, but they are valid input
+		return;
+	}
+
+	_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping == nullptr) {
+		unmap();
+		throw CanNotMapFileError();
+	}
+
+	_data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (_data == nullptr) {
+		unmap();
+		throw CanNotMapFileError();
+	}
+}
+
+void MemoryMappedFile::unmap() noexcept {
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+
+	if (_mapping != nullptr) {
+		CloseHandle(_mapping);
+	}
+
+	if (_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(_file);
+	}
+
+	_data = nullptr;
+	_size = 0;
+	_mapping = nullptr;
+	_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MemoryMappedFile::MemoryMappedFile(const std::string& path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		throw CanNotMapFileError();
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) == -1) {
+		close(fd);
+		throw CanNotMapFileError();
+	}
+
+	_size = static_cast<size_t>(file_stat.st_size);
+	if (_size == 0) {
+		// empty files cannot be mapped, but they are valid input
+		close(fd);
+		return;
+	}
+
+	void* mapped = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping keeps its own reference to the file
+	if (mapped == MAP_FAILED) {
+		_size = 0;
+		throw CanNotMapFileError();
+	}
+
+	madvise(mapped, _size, MADV_SEQUENTIAL);
+	_data = static_cast<const char*>(mapped);
+}
+
+void MemoryMappedFile::unmap() noexcept {
+	if (_data != nullptr) {
+		munmap(const_cast<char*>(_data), _size);
+	}
+
+	_data = nullptr;
+	_size = 0;
+}
+
+#endif
+
+}
@@ -1,3 +1,4 @@
 export module Utils;
 
-export import : CSVParser;
\ No newline at end of file
+export import : CSVParser;
+export import : MemoryMappedFile;
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <vector>
 
 import Utils;
 using namespace utils;
@@ -31,5 +34,90 @@ size_t countRows() {
 }
 
 TEST(CSVParsingTests, CountRows) {
-	EXPECT_EQ(countRows(), 8);
-}
\ No newline at end of file
+	// the newline ending the last row does not start another row
+	EXPECT_EQ(countRows(), 7);
+}
+
+size_t countMappedRows(const std::string& path) {
+	CSVParser parser(path, 7, '\t', true, CSVParser::MEMORY_MAPPED);
+	auto row_stream = parser.getRowStream();
+	size_t row_count = 0;
+	Row row;
+	while (row_stream) {
+		row_stream >> row;
+		++row_count;
+	}
+
+	return row_count;
+}
+
+TEST(CSVParsingTests, MemoryMappedRows) {
+	auto path = (std::filesystem::temp_directory_path() / "CSVParsingTests_MemoryMappedRows.csv").string();
+	{
+		std::ofstream ofs(path, std::ios::binary);
+		ofs << csvTest;
+	}
+
+	EXPECT_EQ(countMappedRows(path), 7);
+
+	CSVParser parser(path, 7, '\t', true, CSVParser::MEMORY_MAPPED);
+	auto row_stream = parser.getRowStream();
+	Row row;
+	row_stream >> row;
+	EXPECT_EQ(row.getColumnCount(), 7);
+
+	auto cell_stream = row.getCellStream();
+	Cell cell;
+	cell_stream >> cell >> cell;
+	EXPECT_EQ(cell.toView(), "15:00:00.017");
+
+	double bid;
+	cell_stream >> cell;
+	EXPECT_TRUE(cell.toNumber(bid));
+	EXPECT_EQ(bid, 0.86682);
+
+	std::filesystem::remove(path);
+}
+
+std::vector<std::string> readRows(CSVParser& parser) {
+	auto row_stream = parser.getRowStream();
+	std::vector<std::string> rows;
+	Row row;
+	while (row_stream) {
+		row_stream >> row;
+		rows.emplace_back(row.toView());
+	}
+
+	return rows;
+}
+
+TEST(CSVParsingTests, StreamAndMappedModesReadSameRows) {
+	std::string crlfTest;
+	for (char c : csvTest) {
+		if (c == '\n') {
+			crlfTest += '\r';
+		}
+
+		crlfTest += c;
+	}
+
+	auto path = (std::filesystem::temp_directory_path() / "CSVParsingTests_StreamAndMappedModesReadSameRows.csv").string();
+	for (const std::string& content : { csvTest, crlfTest }) {
+		{
+			std::ofstream ofs(path, std::ios::binary);
+			ofs << content;
+		}
+
+		std::istringstream iss(content);
+		CSVParser string_parser(&iss, 7, '\t', true);
+		CSVParser file_parser(path, 7, '\t', true, CSVParser::STREAM);
+		CSVParser mapped_parser(path, 7, '\t', true, CSVParser::MEMORY_MAPPED);
+		std::vector<std::string> rows = readRows(mapped_parser);
+		ASSERT_EQ(rows.size(), 7);
+		EXPECT_EQ(rows.back(), "2022.11.10\t15:00:01.596\t0.86682\t0.86713\t\t\t6");
+		EXPECT_EQ(readRows(string_parser), rows);
+		EXPECT_EQ(readRows(file_parser), rows);
+	}
+
+	std::filesystem::remove(path);
+}